@@ -19,10 +19,12 @@ using namespace std;
 #define SIMULATOR_LABEL      "simulator"
 #define REPETITIONS_LABEL    "repetitions"
 #define TMP_DIR_LABEL        "tmp"
+#define PRUNE_LOAD_LABEL     "prune_load"
 
 #define DEF_SIMULATOR        "./noxim"
 #define DEF_REPETITIONS      5
 #define DEF_TMP_DIR          "./"
+#define DEF_PRUNE_LOAD       0.0
 
 #define TMP_FILE_NAME        ".noxim_explorer.tmp"
 
@@ -33,6 +35,7 @@ using namespace std;
 #define THROUGHPUT_LABEL     "% Throughput (flits/cycle/IP):"
 #define MAX_DELAY_LABEL      "% Max delay (cycles):"
 #define TOTAL_ENERGY_LABEL   "% Total energy (J):"
+#define MAX_CHANNEL_LOAD_LABEL "% Maximum channel load:"
 
 #define MATLAB_VAR_NAME      "data"
 #define MATRIX_COLUMN_WIDTH  15
@@ -57,6 +60,7 @@ struct TExplorerParams
   string simulator;
   string tmp_dir;
   int    repetitions;
+  double prune_load;  // skip the configurations predicted above this load
 };
 
 struct TSimulationResults
@@ -455,6 +459,7 @@ bool ExtractExplorerParams(const TParameterSpace& explorer_params,
   eparams.simulator   = DEF_SIMULATOR;
   eparams.tmp_dir     = DEF_TMP_DIR;
   eparams.repetitions = DEF_REPETITIONS;
+  eparams.prune_load  = DEF_PRUNE_LOAD;
 
   for (uint i=0; i<explorer_params.size(); i++)
     {
@@ -469,6 +474,8 @@ bool ExtractExplorerParams(const TParameterSpace& explorer_params,
 	iss >> eparams.repetitions;
       else if (label == TMP_DIR_LABEL)
 	iss >> eparams.tmp_dir;
+      else if (label == PRUNE_LOAD_LABEL)
+	iss >> eparams.prune_load;
       else
 	{
 	  error_msg = "Invalid explorer option '" + label + "'";
@@ -631,6 +638,55 @@ bool RunSimulation(const string& cmd_base,
 
 //---------------------------------------------------------------------------
 
+// Runs the analytic model of the simulator, which takes milliseconds,
+// and returns the load it predicts for the busiest channel
+bool PredictChannelLoad(const string& cmd_base,
+			const string& tmp_dir,
+			double& load,
+			string& error_msg)
+{
+  string tmp_fname = tmp_dir + TMP_FILE_NAME;
+  string cmd = cmd_base + " -analytic >" + tmp_fname + " 2>&1";
+
+  system(cmd.c_str());
+
+  ifstream fin(tmp_fname.c_str(), ios::in);
+  if (!fin)
+    {
+      error_msg = "Cannot read " + tmp_fname;
+      return false;
+    }
+
+  bool found = false;
+  while (!fin.eof() && !found)
+    {
+      string line;
+      getline(fin, line);
+
+      size_t pos = line.find(MAX_CHANNEL_LOAD_LABEL);
+      if (pos != string::npos) 
+	{
+	  found = true;
+	  istringstream iss(line.substr(pos + string(MAX_CHANNEL_LOAD_LABEL).size()));
+	  iss >> load;
+	}
+    }
+  fin.close();
+
+  string rm_cmd = string("rm -f ") + tmp_fname;
+  system(rm_cmd.c_str());
+
+  if (!found)
+    {
+      error_msg = "The analytic model gave no channel load";
+      return false;
+    }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
 string ExtractFirstField(const string& s)
 {
   istringstream iss(s);
@@ -848,6 +904,26 @@ bool RunSimulations(const TConfigurationSpace& conf_space,
 	    + def_cmd_line + " "
 	    + conf_cmd_line;
 
+	  // Configurations that saturate some channel even without
+	  // contention are not worth simulating. The ones the analytic
+	  // model cannot predict (e.g. application traffic) are simulated.
+	  if (eparams.prune_load > 0.0)
+	    {
+	      double load;
+	      if (!PredictChannelLoad(cmd, eparams.tmp_dir, load, error_msg))
+		cout << "Warning: " << error_msg << ", simulating "
+		     << aggr_cmd_line << endl;
+	      else if (load > eparams.prune_load)
+		{
+		  cout << "# skipping " << aggr_cmd_line
+		       << ", predicted channel load " << load << endl;
+		  fout << "% skipped " << aggr_cmd_line
+		       << ", predicted channel load " << load << endl;
+		  sim_counter.first += eparams.repetitions;
+		  continue;
+		}
+	    }
+
 	  if (!RunSimulations(start_time,
 			      sim_counter, cmd, eparams.tmp_dir, eparams.repetitions,
 			      aggr_conf_space[j], fout, error_msg))
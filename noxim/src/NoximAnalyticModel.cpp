@@ -0,0 +1,266 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the analytic zero-load model
+ */
+
+#include "NoximAnalyticModel.h"
+using namespace std;
+
+NoximAnalyticModel::NoximAnalyticModel(NoximNoC * _noc)
+{
+    noc = _noc;
+
+    int n_routers = NoximGlobalParams::mesh_dim_x *
+	NoximGlobalParams::mesh_dim_y;
+
+    routers.assign(n_routers, (NoximRouter *) NULL);
+    for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+	for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	    routers[noc->t[x][y]->r->local_id] = noc->t[x][y]->r;
+
+    packets = 0.0;
+    latency = 0.0;
+    hops = 0.0;
+    max_load = 0.0;
+    max_load_router = NOT_VALID;
+    max_load_port = NOT_VALID;
+    max_load_input = false;
+}
+
+void NoximAnalyticModel::addFlow(const int src_id, const int dst_id,
+				 const double rate)
+{
+    double flits = rate * (NoximGlobalParams::min_packet_size +
+			   NoximGlobalParams::max_packet_size) / 2.0;
+
+    traffic[peRouterId(src_id)][peRouterId(dst_id)] += rate;
+    injected[src_id] += flits;
+    ejected[dst_id] += flits;
+}
+
+void NoximAnalyticModel::buildTrafficMatrix()
+{
+    int n_routers = routers.size();
+    int n_pes = peCount();
+
+    traffic.assign(n_routers, vector <double> (n_routers, 0.0));
+    injected.assign(n_pes, 0.0);
+    ejected.assign(n_pes, 0.0);
+
+    if (NoximGlobalParams::traffic_distribution == TRAFFIC_TABLE_BASED) {
+	for (int s = 0; s < n_pes; s++) {
+	    vector < pair <int, double> > rates =
+		noc->gttable.getAverageRates(s);
+	    for (unsigned int i = 0; i < rates.size(); i++)
+		addFlow(s, rates[i].first, rates[i].second);
+	}
+	return;
+    }
+
+    // A PE injects with probability pir after an idle cycle and with
+    // probability por after a packet
+    double pir = NoximGlobalParams::packet_injection_rate;
+    double por = NoximGlobalParams::probability_of_retransmission;
+    double rate = pir / (1.0 - por + pir);
+
+    for (int s = 0; s < n_pes; s++) {
+	NoximProcessingElement *pe = noc->searchPE(s);
+
+	switch (NoximGlobalParams::traffic_distribution) {
+	case TRAFFIC_RANDOM:
+	    {
+		// the hotspots of the other PEs take their share, the
+		// rest is spread over every PE but the source
+		double uniform = 1.0;
+		for (unsigned int i = 0; i < NoximGlobalParams::hotspots.size(); i++) {
+		    int h = NoximGlobalParams::hotspots[i].first;
+		    double p = min(NoximGlobalParams::hotspots[i].second, uniform);
+		    if (h != s) {
+			addFlow(s, h, rate * p);
+			uniform -= p;
+		    }
+		}
+		for (int d = 0; d < n_pes; d++)
+		    if (d != s)
+			addFlow(s, d, rate * uniform / (n_pes - 1));
+		break;
+	    }
+
+	case TRAFFIC_TRANSPOSE1:
+	    addFlow(s, pe->trafficTranspose1().dst_id, rate);
+	    break;
+
+	case TRAFFIC_TRANSPOSE2:
+	    addFlow(s, pe->trafficTranspose2().dst_id, rate);
+	    break;
+
+	case TRAFFIC_BIT_REVERSAL:
+	    addFlow(s, pe->trafficBitReversal().dst_id, rate);
+	    break;
+
+	case TRAFFIC_SHUFFLE:
+	    addFlow(s, pe->trafficShuffle().dst_id, rate);
+	    break;
+
+	case TRAFFIC_BUTTERFLY:
+	    addFlow(s, pe->trafficButterfly().dst_id, rate);
+	    break;
+
+	default:
+	    assert(false);
+	}
+    }
+}
+
+void NoximAnalyticModel::routeFlow(const int src, const int dst,
+				   const double rate)
+{
+    int C = NoximGlobalParams::concentration;
+    double flits = rate * (NoximGlobalParams::min_packet_size +
+			   NoximGlobalParams::max_packet_size) / 2.0;
+
+    // Fraction of the packets entering each (router, input port), one
+    // hop after the other
+    map < pair <int, int>, double > front;
+    front[pair <int, int> (src, DIRECTION_LOCAL)] = 1.0;
+
+    // the link from the source PE
+    double delay = 1.0;
+
+    for (int h = 0; !front.empty(); h++) {
+	if (h > (int) routers.size()) {
+	    cerr << "Error: the routes from router " << src <<
+		" to router " << dst << " never end" << endl;
+	    exit(1);
+	}
+
+	map < pair <int, int>, double > next;
+
+	for (map < pair <int, int>, double >::iterator i = front.begin();
+	     i != front.end(); i++) {
+	    NoximRouter *r = routers[i->first.first];
+	    double fraction = i->second;
+
+	    if (r->local_id == dst) {
+		delay += fraction * r->zeroLoadDelay(DIRECTION_LOCAL);
+		hops += rate * fraction * h;
+		continue;
+	    }
+
+	    NoximRouteData route_data;
+	    route_data.current_id = r->local_id;
+	    route_data.src_id = src * C;
+	    route_data.dst_id = dst * C;
+	    route_data.dir_in = i->first.second;
+
+	    vector <int> outputs = r->zeroLoadOutputs(route_data);
+	    double share = fraction / outputs.size();
+
+	    for (unsigned int k = 0; k < outputs.size(); k++) {
+		int o = outputs[k];
+		int next_id, next_port;
+
+		if (!noc->downstreamInput(r->local_id, o, next_id, next_port)) {
+		    cerr << "Error: router " << r->local_id <<
+			" routes the packets to router " << dst <<
+			" through output " << o << ", which has no link" <<
+			endl;
+		    exit(1);
+		}
+
+		load[r->local_id][o] += flits * share;
+		delay += share * r->zeroLoadDelay(o);
+		next[pair <int, int> (next_id, next_port)] += share;
+	    }
+	}
+
+	front = next;
+    }
+
+    packets += rate;
+    latency += rate * delay;
+}
+
+void NoximAnalyticModel::updateMaxLoad(const double channel_load,
+				       const int router, const int port,
+				       const bool input)
+{
+    if (channel_load > max_load) {
+	max_load = channel_load;
+	max_load_router = router;
+	max_load_port = port;
+	max_load_input = input;
+    }
+}
+
+void NoximAnalyticModel::evaluate()
+{
+    int n_routers = routers.size();
+
+    buildTrafficMatrix();
+
+    load.assign(n_routers, vector <double> (MAX_ROUTER_PORTS, 0.0));
+
+    for (int s = 0; s < n_routers; s++)
+	for (int d = 0; d < n_routers; d++)
+	    if (traffic[s][d] > 0.0)
+		routeFlow(s, d, traffic[s][d]);
+
+    // the links of the PEs are channels as well
+    for (int p = 0; p < peCount(); p++) {
+	NoximRouter *r = routers[peRouterId(p)];
+	int port = DIRECTION_LOCAL + peIndex(p);
+
+	load[r->local_id][port] += ejected[p];
+	updateMaxLoad(injected[p] / r->outputCapacity(port), r->local_id,
+		      port, true);
+    }
+
+    for (int r = 0; r < n_routers; r++)
+	for (int o = 0; o < MAX_ROUTER_PORTS; o++)
+	    if (load[r][o] > 0.0)
+		updateMaxLoad(load[r][o] / routers[r]->outputCapacity(o), r,
+			      o, false);
+}
+
+double NoximAnalyticModel::getZeroLoadLatency() const
+{
+    return packets > 0.0 ? latency / packets : 0.0;
+}
+
+double NoximAnalyticModel::getAverageHops() const
+{
+    return packets > 0.0 ? hops / packets : 0.0;
+}
+
+double NoximAnalyticModel::getMaxChannelLoad() const
+{
+    return max_load;
+}
+
+void NoximAnalyticModel::showResults(std::ostream & out) const
+{
+    double offered = 0.0;
+    for (unsigned int p = 0; p < injected.size(); p++)
+	offered += injected[p];
+    offered /= injected.size();
+
+    out << "% Offered load (flits/cycle/IP): " << offered << endl;
+    out << "% Zero-load latency (cycles): " << getZeroLoadLatency() << endl;
+    out << "% Average hops: " << getAverageHops() << endl;
+    out << "% Maximum channel load: " << max_load;
+    if (max_load_router != NOT_VALID)
+	out << " (Router[" << max_load_router << "] " <<
+	    (max_load_input ? "Input[" : "Output[") << max_load_port << "])";
+    out << endl;
+
+    // the throughput at which the busiest channel would be always busy
+    if (max_load > 0.0)
+	out << "% Ideal saturation throughput (flits/cycle/IP): " <<
+	    offered / max_load << endl;
+}
@@ -0,0 +1,80 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the analytic zero-load model
+ */
+
+#ifndef __NOXIMANALYTICMODEL_H__
+#define __NOXIMANALYTICMODEL_H__
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include "NoximNoC.h"
+#include "NoximTile.h"
+using namespace std;
+
+// The traffic matrix of the configured distribution is routed through
+// the network without simulating it: every packet is split evenly among
+// the outputs the routing function admits. The result is the latency
+// of an empty network and the load of every channel.
+class NoximAnalyticModel {
+
+  public:
+
+    NoximAnalyticModel(NoximNoC * _noc);
+
+    // Builds the traffic matrix and routes it
+    void evaluate();
+
+    // Average head flit latency of an empty network (cycles)
+    double getZeroLoadLatency() const;
+
+    // Average number of links between two routers crossed by a packet
+    double getAverageHops() const;
+
+    // Flits per cycle over the capacity of the most loaded channel
+    double getMaxChannelLoad() const;
+
+    void showResults(std::ostream & out) const;
+
+  private:
+
+    NoximNoC *noc;
+    vector <NoximRouter *> routers;	// Indexed by router id
+
+    // Packets per cycle between each pair of routers and flits per
+    // cycle injected and ejected by each PE
+    vector < vector <double> > traffic;
+    vector <double> injected;
+    vector <double> ejected;
+
+    // Flits per cycle through each output of each router
+    vector < vector <double> > load;
+
+    double packets;		// Packets per cycle in the whole network
+    double latency;		// Sums of the delays and of the hops,
+    double hops;		// weighted by the rate of each flow
+
+    double max_load;
+    int max_load_router;
+    int max_load_port;
+    bool max_load_input;	// The channel is the link of a PE
+
+    void buildTrafficMatrix();
+
+    // Packets per cycle between PEs src_id and dst_id
+    void addFlow(const int src_id, const int dst_id, const double rate);
+
+    // Routes the packets from router src to router dst
+    void routeFlow(const int src, const int dst, const double rate);
+
+    void updateMaxLoad(const double channel_load, const int router,
+		       const int port, const bool input);
+};
+
+#endif
@@ -6,15 +6,6 @@ double lambda;
 double logtmin, logtmax;
 double maxpar;
 
-bool MyCompareAscend(const PEPrice& d1, const PEPrice& d2)
-{
-  return d1.price < d2.price;
-}
-bool MyCompareDscend(const PEPrice& d1, const PEPrice& d2)
-{
-  return d1.price > d2.price;
-}
-
 void initial_parameters(){
     double mu;
     seed = 36;
@@ -22,12 +13,34 @@ void initial_parameters(){
     logtmin = 3.0;
     logtmax = 13.0;
     //maxpar = NUM_PES;
-    maxpar = NoximGlobalParams::mesh_dim_x*NoximGlobalParams::mesh_dim_y;
+    maxpar = peCount();
     mu = avg_lifetime ();
     lambda = rho * maxpar / mu;
     srandom (seed);
 }
 
+void generate_arrivals (vector<APPLICATION> & apps)
+{
+	double cycle = NoximGlobalParams::stats_warm_up_time + DEFAULT_RESET_TIME;	
+	initial_parameters();
+	APPLICATION temp_app;
+	for (int i=0; i<NPROCS; i++) {
+		temp_app.app_id = i;
+		temp_app.arrival = cycle;
+		temp_app.lifetime = choose_lifetime ();
+		temp_app.A = choose_parallelism ();
+		temp_app.sig = choose_sigma ();
+		temp_app.money_used = 0;
+		temp_app.money_allowed = 0;
+		apps.push_back (temp_app);
+		cycle += max(1.0, choose_from_exponential ());
+  	}
+  	//int s[10];
+  	//for (int i = 0; i < 10000; i++)
+  		//cout << choose_from_log_uniform(1, 10) << endl;
+  		//cout << drandom () << endl;
+}
+
 double drandom ()
 {
   return (double) (random() & 0x7fffffff) / (double) 0x7fffffff;
@@ -89,7 +102,7 @@ double choose_sigma ()
 // Used for application generation and mapping
 
 //float Application::Sa (int n, float A, float cv2)
-float Application::Sa (int n)
+float Application::Sa (int n) const
 {
   /*if (cv2 <= 1.0) {
  
@@ -129,146 +142,212 @@ float Application::Sa (int n)
 }
 
 
+int Application::useful_cores() const{
+  double n;
+  if (sig <= 1.0)
+    n = 2*A - 1;
+  else
+    n = A*sig + A - sig;
+  return max(1, min(peCount(), (int)ceil(n)));
+}
+
+int Application::task_core(int task) const{
+  return cores[task % cores.size()];
+}
+
 void Application::mapToCore(deque<int> core_list){
   cores = core_list;
 }
 
-void Application::ini_mapping(int n, int time){
-  cores.push_back(n);
+void Application::ini_mapping(int n, int time, const NoximLifetime & pes){
+  add_core(n, pes);
   mapping_time = (double)time;
 }
 
-void Application::get_neighbors(){
-  neighbors.clear();
-  for (deque<int>::iterator it = cores.begin(); it != cores.end(); it++){
-    int x = id2Coord(*it).x;
-    int y = id2Coord(*it).y;
-    if (x+1 < NoximGlobalParams::mesh_dim_x){
-      if (find(neighbors.begin(), neighbors.end(), (*it+1)) == neighbors.end()){
-        neighbors.push_back(*it+1);
-      }
-    }
-    if (x-1 >= 0){
-      if (find(neighbors.begin(), neighbors.end(), (*it-1)) == neighbors.end()){
-        neighbors.push_back(*it-1);
-      }
-    }
-    if (y+1 < NoximGlobalParams::mesh_dim_y){
-      if (find(neighbors.begin(), neighbors.end(), (*it+NoximGlobalParams::mesh_dim_y)) == neighbors.end()){
-        neighbors.push_back(*it+NoximGlobalParams::mesh_dim_y);
+// They are computed once per core
+const vector<int> & adjacent_cores(int n){
+  static vector< vector<int> > adjacency;
+  if (adjacency.size() != peCount()){
+    adjacency.assign(peCount(), vector<int>());
+    int c = NoximGlobalParams::concentration;
+    const int dx[4] = {1, -1, 0, 0};
+    const int dy[4] = {0, 0, 1, -1};
+
+    for (int m = 0; m < peCount(); m++){
+      int router = peRouterId(m);
+      NoximCoord coord = id2Coord(router);
+
+      for (int k = 0; k < c; k++)
+        if (router*c + k != m)
+          adjacency[m].push_back(router*c + k);
+
+      for (int d = 0; d < 4; d++){
+        NoximCoord next;
+        next.x = coord.x + dx[d];
+        next.y = coord.y + dy[d];
+        if (next.x < 0 || next.x >= NoximGlobalParams::mesh_dim_x ||
+            next.y < 0 || next.y >= NoximGlobalParams::mesh_dim_y)
+          continue;
+        for (int k = 0; k < c; k++)
+          adjacency[m].push_back(coord2Id(next)*c + k);
       }
     }
-    if (y-1 >= 0){
-      if (find(neighbors.begin(), neighbors.end(), (*it-NoximGlobalParams::mesh_dim_y)) == neighbors.end()){
-        neighbors.push_back(*it-NoximGlobalParams::mesh_dim_y);
-      }
+  }
+  return adjacency[n];
+}
+
+// Core m is a margin if some of the PEs next to it are outside
+static void update_margin(set<int> & margins, int m, bool in_region, int touching){
+  if (in_region && touching < (int)adjacent_cores(m).size())
+    margins.insert(m);
+  else
+    margins.erase(m);
+}
+
+void Application::add_core(int n, const NoximLifetime & pes){
+  if (region.size() != peCount()){
+    region.assign(peCount(), false);
+    touching.assign(peCount(), 0);
+    indexed_price.assign(peCount(), 0.0);
+    held.assign(peCount(), false);
+    deferring = false;
+  }
+  cores.push_back(n);
+  region[n] = true;
+  neighbors.erase(n);
+  update_margin(margins, n, true, touching[n]);
+  reindex(n, pes);
+
+  const vector<int> & adjacent = adjacent_cores(n);
+  for (vector<int>::const_iterator a = adjacent.begin(); a != adjacent.end(); a++){
+    touching[*a]++;
+    if (!region[*a])
+      neighbors.insert(*a);
+    update_margin(margins, *a, region[*a], touching[*a]);
+    // a neighbor found while expanding waits for the next expand
+    if (deferring && !region[*a] && touching[*a] == 1){
+      held[*a] = true;
+      deferred.push_back(*a);
     }
+    reindex(*a, pes);
   }
 }
 
-void Application::get_margins(){
-  margins.clear();
+void Application::remove_core(int n, const NoximLifetime & pes){
   for (deque<int>::iterator it = cores.begin(); it != cores.end(); it++){
-    int x = id2Coord(*it).x;
-    int y = id2Coord(*it).y;
-    bool flag = 0;
-    if (x+1 < NoximGlobalParams::mesh_dim_x){
-      if (find(cores.begin(), cores.end(), (*it+1)) == cores.end()){
-        flag = flag | 1;
-      }
-    }
-    if (x-1 >= 0){
-      if (find(cores.begin(), cores.end(), (*it-1)) == cores.end()){
-        flag = flag | 1;
-      }
-    }
-    if (y+1 < NoximGlobalParams::mesh_dim_y){
-      if (find(cores.begin(), cores.end(), (*it+NoximGlobalParams::mesh_dim_y)) == cores.end()){
-        flag = flag | 1;
-      }
+    if (*it == n){
+      cores.erase(it);
+      break;
     }
-    if (y-1 >= 0){
-      if (find(cores.begin(), cores.end(), (*it-NoximGlobalParams::mesh_dim_y)) == cores.end()){
-        flag = flag | 1;
-      }
+  }
+  region[n] = false;
+  margins.erase(n);
+  if (touching[n] > 0)
+    neighbors.insert(n);
+  reindex(n, pes);
+
+  const vector<int> & adjacent = adjacent_cores(n);
+  for (vector<int>::const_iterator a = adjacent.begin(); a != adjacent.end(); a++){
+    bool was_margin = margins.count(*a) > 0;
+    touching[*a]--;
+    if (!region[*a] && touching[*a] == 0)
+      neighbors.erase(*a);
+    update_margin(margins, *a, region[*a], touching[*a]);
+    // and so does a margin found while shrinking
+    if (deferring && region[*a] && !was_margin){
+      held[*a] = true;
+      deferred.push_back(*a);
     }
-    if (flag)
-      margins.push_back(*it);
+    reindex(*a, pes);
   }
 }
 
-
-int Application::expand(NoximTile* t[32][32]){
+void Application::clear_cores(){
+  cores.clear();
+  region.clear();
+  touching.clear();
   neighbors.clear();
-  get_neighbors();
-  deque<PEPrice> free_neighbors;
-  for (deque<int>::iterator it = neighbors.begin(); it != neighbors.end(); it++){
-    int x = id2Coord(*it).x;
-    int y = id2Coord(*it).y;
-    if (!t[x][y]->pe->occupied){
-      PEPrice temp;
-      temp.id = *it;
-      temp.price = t[x][y]->pe->price;
-      free_neighbors.push_back(temp);
-    }
-  }
-  if (free_neighbors.size() == 0)
-    return 0;
-  else{
-    sort(free_neighbors.begin(), free_neighbors.end(), MyCompareAscend);
-    float cheapest = free_neighbors[0].price;
-    if (money_allowed - money_used < cheapest){
-        return 0;
-    }
-    for (deque<PEPrice>::iterator it = free_neighbors.begin(); it != free_neighbors.end(); it++){
-      //float cheapest = t[id2Coord(free_neighbors[0].id).x)][id2Coord(free_neighbors[0].id).y)]->pe->price;
-      if (money_allowed >= money_used + it->price) {
-        invade(it->id, t);
-      }
-    }
+  margins.clear();
+  hireable.clear();
+  priced_margins.clear();
+  indexed_price.clear();
+  deferred.clear();
+  held.clear();
+}
+
+void Application::reindex(int n, const NoximLifetime & pes){
+  if (region.size() != peCount() || held[n])
+    return;
+  hireable.erase(make_pair(indexed_price[n], n));
+  priced_margins.erase(make_pair(indexed_price[n], n));
+  indexed_price[n] = pes.getPrice(n);
+
+  if (region[n]){
+    if (margins.count(n))
+      priced_margins.insert(make_pair(indexed_price[n], n));
   }
+  else if (touching[n] > 0 && pes.freeCores().contains(n))
+    hireable.insert(make_pair(indexed_price[n], n));
 }
 
-int Application::shrink(NoximTile* t[32][32]){
-  get_margins();
-  deque<PEPrice> inner_margins;
-  for (deque<int>::iterator it = margins.begin(); it != margins.end(); it++){
-    PEPrice temp;
-    int x = id2Coord(*it).x;
-    int y = id2Coord(*it).y;
-    temp.id = *it;
-    temp.price = t[x][y]->pe->price;
-    inner_margins.push_back(temp);
+// Every price has changed: the sets are built again
+void Application::reprice(const NoximLifetime & pes){
+  hireable.clear();
+  priced_margins.clear();
+  for (set<int>::iterator it = neighbors.begin(); it != neighbors.end(); it++)
+    reindex(*it, pes);
+  for (set<int>::iterator it = margins.begin(); it != margins.end(); it++)
+    reindex(*it, pes);
+}
+
+// The PEs deferred while walking the sets join them
+static void flush_deferred(Application & a, const NoximLifetime & pes){
+  a.deferring = false;
+  for (vector<int>::iterator it = a.deferred.begin(); it != a.deferred.end(); it++){
+    a.held[*it] = false;
+    a.reindex(*it, pes);
   }
-  sort(inner_margins.begin(), inner_margins.end(), MyCompareDscend);
-  for (deque<PEPrice>::iterator it = inner_margins.begin(); it != inner_margins.end(); it++){
-    if (money_used > money_allowed){
-      retreat(it->id, t);
-    }
+  a.deferred.clear();
+}
+
+int Application::expand(NoximLifetime & pes){
+  // the cheapest neighbor comes first: the first one that cannot be
+  // afforded ends the walk
+  int invaded = 0;
+  deferring = true;
+  while (!hireable.empty() && money_allowed >= money_used + hireable.begin()->first){
+    invade(hireable.begin()->second, pes);
+    invaded++;
   }
+  flush_deferred(*this, pes);
+  return invaded;
+}
 
+int Application::shrink(NoximLifetime & pes){
+  // the most expensive margin goes first, and an application keeps at
+  // least one core
+  int retreated = 0;
+  deferring = true;
+  while (!priced_margins.empty() && money_used > money_allowed && cores.size() > 1){
+    retreat((--priced_margins.end())->second, pes);
+    retreated++;
+  }
+  flush_deferred(*this, pes);
+  return retreated;
 }
-void Application::Application::claim(int n, NoximTile* t[32][32]){
+void Application::Application::claim(int n, NoximLifetime & pes){
 }
-void Application::invade(int n, NoximTile* t[32][32]){
-  int x = id2Coord(n).x;
-  int y = id2Coord(n).y;
-  //t[x][y]->pe->occupied = 1;
-  //t[x][y]->pe->app = *this;
-  t[x][y]->pe->mapTask(arrival, arrival + lifetime);
+void Application::invade(int n, NoximLifetime & pes){
+  //pe->occupied = 1;
+  //pe->app = *this;
+  pes.mapTask(n, app_id, mapping_time + lifetime);
 
-  cores.push_back(n);
-  money_used += t[x][y]->pe->price;
+  add_core(n, pes);
+  money_used += pes.getPrice(n);
 }
-void Application::retreat(int n, NoximTile* t[32][32]){
-  int x = id2Coord(n).x;
-  int y = id2Coord(n).y;
-  t[x][y]->pe->clearTask();
+void Application::retreat(int n, NoximLifetime & pes){
+  pes.clearTask(n);
 
-  money_used -= t[x][y]->pe->price;
-  for (deque<int>::iterator it = cores.begin(); it != cores.end(); it++){
-    if (*it == n){
-      cores.erase(it);
-    } 
-  }
+  money_used -= pes.getPrice(n);
+  remove_core(n, pes);
 }
\ No newline at end of file
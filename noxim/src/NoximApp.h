@@ -3,11 +3,21 @@
 
 #include <cmath>
 #include <deque>
+#include <set>
+#include <vector>
 #include <algorithm>
 #include "NoximMain.h"
-#include "NoximTile.h"
+#include "NoximLifetime.h"
 using namespace std;
 
+// NoximTaskCommunication -- Edge of the communication graph of an
+// application, from a task of it to another one
+struct NoximTaskCommunication {
+	int src;
+	int dst;
+	double volume;	// Share of the data sent by the application
+};
+
 typedef struct Application{
 	int app_id;
 	double arrival;
@@ -15,29 +25,73 @@ typedef struct Application{
 	double lifetime;
 	double A;
 	double sig;
+	// Tasks are numbered from 0, empty if unknown
+	vector <NoximTaskCommunication> graph;
 	deque <int> cores;
 
 	void mapToCore(deque<int>);
 	float speedup;
 	
-	deque <int> neighbors;
-	deque <int> margins;
+	// The region of the cores, kept up to date by add_core and
+	// remove_core: neighbors are the PEs next to the region, margins
+	// the cores with a PE next to them outside of it
+	vector <bool> region;
+	vector <int> touching;	// Cores next to each PE
+	set <int> neighbors;
+	set <int> margins;
+	// The same PEs by price, for expand and shrink: the neighbors
+	// that can be hired, cheapest first, and the margins
+	set < pair<double,int> > hireable;
+	set < pair<double,int> > priced_margins;
+	vector <double> indexed_price;	// Key of each PE in them
+	bool deferring;	// expand or shrink walks them
+	vector <int> deferred;	// PEs that joined them meanwhile,
+	vector <bool> held;	// left out until the walk ends
 	float money_used;
 	float money_allowed;
 	//float Sa (int n, float A, float cv2);
-	float Sa (int n);
-	void ini_mapping(int n, int time);
-	int expand(NoximTile* t[32][32]);
-	int shrink(NoximTile* t[32][32]);
-	void claim(int n, NoximTile* t[32][32]);
-	void invade(int n, NoximTile* t[32][32]);
-	void retreat(int n, NoximTile* t[32][32]);
-
-	void get_neighbors();
-	void get_margins();
+	float Sa (int n) const;
+	int useful_cores() const;  // beyond them Sa grows no more
+	// Core running task: the tasks are dealt over the cores in order
+	int task_core(int task) const;
+	void ini_mapping(int n, int time, const NoximLifetime & pes);
+	int expand(NoximLifetime & pes);
+	int shrink(NoximLifetime & pes);
+	void claim(int n, NoximLifetime & pes);
+	void invade(int n, NoximLifetime & pes);
+	void retreat(int n, NoximLifetime & pes);
+
+	void add_core(int n, const NoximLifetime & pes);
+	void remove_core(int n, const NoximLifetime & pes);
+	void clear_cores();
+	// Files PE n in hireable or priced_margins, if it belongs there
+	void reindex(int n, const NoximLifetime & pes);
+	void reprice(const NoximLifetime & pes);
 }APPLICATION;
 
+// NoximMappingEvent -- Something that changes the mapping at a given
+// cycle
+struct NoximMappingEvent {
+	double time;
+	int type;	// MAPPING_EVENT_COMPLETION, _PRICE_UPDATE or _ARRIVAL
+	int app;	// Key of the application in app_queue, if any
+
+	inline bool operator >(const NoximMappingEvent & e) const {
+		if (time != e.time)
+			return time > e.time;
+		if (type != e.type)
+			return type > e.type;
+		return app > e.app;
+	}
+};
+
+// PEs next to PE n: the other PEs of its router and the PEs of the
+// routers adjacent to it in the mesh
+const vector<int> & adjacent_cores(int n);
+
 void initial_parameters();
+// The synthetic applications of a run, in order of arrival
+void generate_arrivals (vector<APPLICATION> & apps);
 double drandom ();
 double choose_from_exponential ();
 double choose_from_log_uniform (double low, double high);
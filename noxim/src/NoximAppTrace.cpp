@@ -0,0 +1,155 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the traces of applications
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include "NoximAppTrace.h"
+
+NoximAppTrace *NoximAppTrace::create()
+{
+    if (NoximGlobalParams::app_trace_filename[0] != '\0')
+	return new NoximFileAppTrace(NoximGlobalParams::app_trace_filename);
+
+    return new NoximSyntheticAppTrace();
+}
+
+bool NoximAppTrace::save(const char *fname)
+{
+    ofstream fout(fname, ios::out);
+    if (!fout)
+	return false;
+
+    // the lifetimes are not integers: keep every digit, so that the
+    // trace read back is the same
+    fout.precision(numeric_limits <double>::digits10 + 2);
+    fout << "% arrival lifetime A sigma [edges]" << endl;
+
+    rewind();
+    APPLICATION app;
+    while (next(app)) {
+	fout << app.arrival << " " << app.lifetime << " " << app.A << " " <<
+	    app.sig;
+	if (!app.graph.empty())
+	    fout << " " << app.graph.size();
+	fout << endl;
+
+	for (unsigned int i = 0; i < app.graph.size(); i++)
+	    fout << app.graph[i].src << " " << app.graph[i].dst << " " <<
+		app.graph[i].volume << endl;
+    }
+    rewind();
+
+    return fout.good();
+}
+
+NoximSyntheticAppTrace::NoximSyntheticAppTrace()
+{
+    generate_arrivals(apps);
+    current = 0;
+}
+
+bool NoximSyntheticAppTrace::next(APPLICATION & app)
+{
+    if (current >= apps.size())
+	return false;
+
+    app = apps[current++];
+    return true;
+}
+
+void NoximSyntheticAppTrace::rewind()
+{
+    current = 0;
+}
+
+NoximFileAppTrace::NoximFileAppTrace(const char *_fname)
+:fname(_fname)
+{
+    rewind();
+}
+
+void NoximFileAppTrace::rewind()
+{
+    fin.close();
+    fin.clear();
+    fin.open(fname.c_str(), ios::in);
+    if (!fin) {
+	cerr << "Error: cannot open application trace " << fname << endl;
+	exit(1);
+    }
+
+    line_number = 0;
+    count = 0;
+    last_arrival = 0.0;
+}
+
+void NoximFileAppTrace::error(const char *msg) const
+{
+    cerr << "Error: " << fname << ", line " << line_number << ": " << msg <<
+	endl;
+    exit(1);
+}
+
+bool NoximFileAppTrace::readLine(char *line, const int size)
+{
+    while (fin.getline(line, size)) {
+	line_number++;
+	if (line[0] != '\0' && line[0] != '%')
+	    return true;
+    }
+
+    if (!fin.eof())
+	error("line too long");
+
+    return false;
+}
+
+bool NoximFileAppTrace::next(APPLICATION & app)
+{
+    char line[512];
+    if (!readLine(line, sizeof(line)))
+	return false;
+
+    double arrival, lifetime, A, sig;
+    int edges = 0;
+    int params = sscanf(line, "%lf %lf %lf %lf %d", &arrival, &lifetime, &A,
+			&sig, &edges);
+    if (params < 4)
+	error("expected ARRIVAL LIFETIME A SIGMA [EDGES]");
+    if (arrival < last_arrival)
+	error("the applications must be in order of arrival");
+    if (lifetime < 0 || A < 1 || sig < 0 || edges < 0)
+	error("invalid application");
+
+    app = APPLICATION();
+    app.app_id = count++;
+    app.arrival = arrival;
+    app.lifetime = lifetime;
+    app.A = A;
+    app.sig = sig;
+    app.money_used = 0;
+    app.money_allowed = 0;
+    last_arrival = arrival;
+
+    for (int i = 0; i < edges; i++) {
+	if (!readLine(line, sizeof(line)))
+	    error("missing edges of the communication graph");
+
+	NoximTaskCommunication c;
+	c.volume = 1.0;
+	params = sscanf(line, "%d %d %lf", &c.src, &c.dst, &c.volume);
+	if (params < 2 || c.src < 0 || c.dst < 0 || c.volume < 0)
+	    error("expected SRC DST [VOLUME]");
+	app.graph.push_back(c);
+    }
+
+    return true;
+}
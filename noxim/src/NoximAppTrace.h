@@ -0,0 +1,81 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the traces of applications
+ */
+
+#ifndef __NOXIMAPPTRACE_H__
+#define __NOXIMAPPTRACE_H__
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "NoximMain.h"
+#include "NoximApp.h"
+using namespace std;
+
+// The applications arriving during a run, read one at a time in order
+// of arrival, so that a trace need not fit in memory
+class NoximAppTrace {
+  public:
+
+    virtual ~NoximAppTrace() {}
+
+    // Next application, false once the trace is over. The applications
+    // are numbered from 0 in app_id.
+    virtual bool next(APPLICATION & app) = 0;
+
+    // Starts over from the first application
+    virtual void rewind() = 0;
+
+    // Writes the whole trace to file fname in the format read by
+    // NoximFileAppTrace, and starts over. False if the file cannot be
+    // written.
+    bool save(const char *fname);
+
+    // The trace of the command line: the file given with -apptrace, if
+    // any, or the synthetic one
+    static NoximAppTrace *create();
+};
+
+// The NPROCS applications drawn from the distributions of NoximApp
+class NoximSyntheticAppTrace : public NoximAppTrace {
+  public:
+    NoximSyntheticAppTrace();
+    bool next(APPLICATION & app);
+    void rewind();
+
+  private:
+    vector <APPLICATION> apps;
+    unsigned int current;
+};
+
+// A trace file, with one application per line:
+//
+//   ARRIVAL LIFETIME A SIGMA [EDGES]
+//
+// followed by EDGES lines "SRC DST [VOLUME]" with the communication
+// graph of the application. Lines starting with % are comments.
+class NoximFileAppTrace : public NoximAppTrace {
+  public:
+    NoximFileAppTrace(const char *_fname);
+    bool next(APPLICATION & app);
+    void rewind();
+
+  private:
+    string fname;
+    ifstream fin;
+    int line_number;
+    int count;			// Applications read so far
+    double last_arrival;
+
+    // Next line that is not empty nor a comment, false at the end
+    bool readLine(char *line, const int size);
+    void error(const char *msg) const;
+};
+
+#endif
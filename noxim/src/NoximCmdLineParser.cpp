@@ -9,6 +9,7 @@
  */
 
 #include "NoximCmdLineParser.h"
+#include "NoximGlobalTopology.h"
 
 void showHelp(char selfname[])
 {
@@ -28,6 +29,43 @@ void showHelp(char selfname[])
     cout <<
 	"\t-dimy N\t\tSet the mesh Y dimension to the specified integer value (default "
 	<< DEFAULT_MESH_DIM_Y << ")" << endl;
+    cout <<
+	"\t-topology TYPE\tSet the topology to TYPE where TYPE is one of the following (default "
+	<< DEFAULT_TOPOLOGY << "):" << endl;
+    cout << "\t\tmesh\t\t2D mesh" << endl;
+    cout << "\t\ttorus\t\t2D torus with dateline virtual channels" << endl;
+    cout << "\t\tfoldedtorus\tFolded 2D torus with dateline virtual channels" << endl;
+    cout << "\t\tgraph FILENAME\tRouters connected as described in the specified file" << endl;
+    cout <<
+	"\t-concentration N\tAttach N PEs to each router (default "
+	<< DEFAULT_CONCENTRATION << ")" << endl;
+    cout <<
+	"\t-chips CX CY\tSplit the mesh into CX x CY chips connected by slow inter-chip links (default "
+	<< DEFAULT_CHIPS_X << " " << DEFAULT_CHIPS_Y << ")" << endl;
+    cout <<
+	"\t-chiplinks N\tSet the number of links along each edge shared by two chips (default "
+	<< DEFAULT_CHIP_LINKS << ")" << endl;
+    cout <<
+	"\t-chiplatency N\tSet the cycles needed to cross an inter-chip link (default "
+	<< DEFAULT_CHIP_LINK_LATENCY << ")" << endl;
+    cout <<
+	"\t-chipperiod N\tSet the cycles between two transfers on an inter-chip link (default "
+	<< DEFAULT_CHIP_LINK_PERIOD << ")" << endl;
+    cout <<
+	"\t-express K\tAdd express links skipping K routers along rows and columns (default off)"
+	<< endl;
+    cout <<
+	"\t-expresslatency N\tSet the cycles needed to cross an express link (default "
+	<< DEFAULT_EXPRESS_LATENCY << ")" << endl;
+    cout <<
+	"\t-smart HPC\tLet flits go through up to HPC-1 idle routers in a single cycle (default "
+	<< DEFAULT_SMART_HPC_MAX << ", i.e. no bypass)" << endl;
+    cout <<
+	"\t-deadlock N ACTION\tLook for deadlocks every N cycles (default off) and then:"
+	<< endl;
+    cout << "\t\treport\t\tReport the channels involved (default)" << endl;
+    cout << "\t\tabort\t\tStop the simulation" << endl;
+    cout << "\t\tdrain\t\tDrop one of the deadlocked packets" << endl;
     cout <<
 	"\t-buffer N\tSet the buffer depth of each channel of the router to the specified integer value [flits] (default "
 	<< DEFAULT_BUFFER_DEPTH << ")" << endl;
@@ -56,6 +94,34 @@ void showHelp(char selfname[])
     cout << "\t\tbufferlevel\tBuffer-Level Based selection strategy" <<
 	endl;
     cout << "\t\tnop\t\tNeighbors-on-Path selection strategy" << endl;
+    cout << "\t\trca\t\tRegional Congestion Awareness selection strategy" <<
+	endl;
+    cout <<
+	"\t-alloc TYPE\tSet the switch allocator to TYPE where TYPE is one of the following (default "
+	<< DEFAULT_SWITCH_ALLOCATOR << "):" << endl;
+    cout << "\t\trr\t\tRound-robin input priority" << endl;
+    cout << "\t\tislip N\t\tiSLIP separable allocator with N iterations" <<
+	endl;
+    cout << "\t\twavefront\tWavefront allocator" << endl;
+    cout <<
+	"\t-linkwidth N\tSet the number of flits each link carries per cycle (default "
+	<< DEFAULT_LINK_WIDTH << ", max " << MAX_LINK_WIDTH << ")" << endl;
+    cout <<
+	"\t-speedup N\tSet the crossbar speedup, i.e. switch traversals per cycle (default "
+	<< DEFAULT_CROSSBAR_SPEEDUP << ")" << endl;
+    cout <<
+	"\t-pipeline RC SA ST LT\tSet the cycles spent by a head flit in the route computation, allocation, switch traversal and link traversal stages (default "
+	<< DEFAULT_RC_STAGES << " " << DEFAULT_SA_STAGES << " " <<
+	DEFAULT_ST_STAGES << " " << DEFAULT_LT_STAGES << ")" << endl;
+    cout <<
+	"\t-lookahead\tModel routes computed one hop ahead by removing the route computation stage (timing only)"
+	<< endl;
+    cout <<
+	"\t-linklatency N\tSet the cycles needed to cross a link between two routers (default "
+	<< DEFAULT_LINK_LATENCY << ")" << endl;
+    cout <<
+	"\t-linkpipeline\tInsert registers in the links, so that a new transfer can start every cycle"
+	<< endl;
     cout <<
 	"\t-pir R TYPE\t\tSet the packet injection rate to the specified real value [0..1] (default "
 	<< DEFAULT_PACKET_INJECTION_RATE <<
@@ -82,12 +148,33 @@ void showHelp(char selfname[])
     cout << "\t\tbitreversal\tBit-reversal traffic distribution" << endl;
     cout << "\t\tbutterfly\tButterfly traffic distribution" << endl;
     cout << "\t\tshuffle\t\tShuffle traffic distribution" << endl;
+    cout << "\t\tapplication\tAmong the cores of the applications mapped, busy PEs only" << endl;
     cout <<
 	"\t\ttable FILENAME\tTraffic Table Based traffic distribution with table in the specified file"
 	<< endl;
     cout <<
 	"\t-hs ID P\tAdd node ID to hotspot nodes, with percentage P (0..1) (Only for 'random' traffic)"
 	<< endl;
+    cout <<
+	"\t-mapping POLICY\tMap the applications with POLICY, one of the following (default moc). Repeat it to compare several policies on the same applications:"
+	<< endl;
+    cout << "\t\tmoc\t\tMarket of cores: the applications hire the cheapest PEs" << endl;
+    cout << "\t\trandom\t\tRandom free PEs" << endl;
+    cout << "\t\tcontiguous\tA region of free PEs grown from the first one" << endl;
+    cout << "\t\tfirstfit\tThe free PEs with the lowest ids" << endl;
+    cout << "\t\tcommaware\tA region of free PEs grown to keep the communicating tasks close" << endl;
+    cout <<
+	"\t-mappingonly\tSimulate the mapping of the applications and the lifetime budgets only, without the network"
+	<< endl;
+    cout <<
+	"\t-apptrace FILENAME\tRead the applications from the trace in FILENAME instead of generating them"
+	<< endl;
+    cout <<
+	"\t-appdump FILENAME\tWrite the trace of the applications to FILENAME"
+	<< endl;
+    cout <<
+	"\t-thermal\tScale the wear of the busy PEs with the temperature of their tiles"
+	<< endl;
     cout <<
         "\t-pwr FILENAME\tRouter and link power data (default " 
          << DEFAULT_ROUTER_PWR_FILENAME << ")" << endl;
@@ -108,6 +195,15 @@ void showHelp(char selfname[])
     cout <<
 	"\t-volume N\tStop the simulation when either the maximum number of cycles has been reached or N flits have been delivered"
 	<< endl;
+    cout <<
+	"\t-converge E N\tStop the simulation when delay and throughput, measured in batches of N cycles, are known with relative precision E or diverge (default off)"
+	<< endl;
+    cout <<
+	"\t-satsearch T\tSearch the saturation injection rate with relative tolerance T, starting from -pir (needs -converge)"
+	<< endl;
+    cout <<
+	"\t-analytic\tEstimate zero-load latency and channel loads analytically, without simulating"
+	<< endl;
     cout <<
 	"\t-sim N\t\tRun for the specified simulation time [cycles] (default "
 	<< DEFAULT_SIMULATION_TIME << ")" << endl << endl;
@@ -133,11 +229,47 @@ void showConfig()
     cout << "- buffer_depth = " << NoximGlobalParams::buffer_depth << endl;
     cout << "- max_packet_size = " << NoximGlobalParams::
 	max_packet_size << endl;
+    cout << "- topology = " << NoximGlobalParams::topology << endl;
+    cout << "- virtual_channels = " << NoximGlobalParams::
+	virtual_channels << endl;
+    cout << "- concentration = " << NoximGlobalParams::
+	concentration << endl;
+    cout << "- chips = " << NoximGlobalParams::chips_x << " " <<
+	NoximGlobalParams::chips_y << endl;
+    cout << "- chip_links = " << NoximGlobalParams::chip_links << endl;
+    cout << "- chip_link_latency = " << NoximGlobalParams::
+	chip_link_latency << endl;
+    cout << "- chip_link_period = " << NoximGlobalParams::
+	chip_link_period << endl;
+    cout << "- express_span = " << NoximGlobalParams::express_span << endl;
+    cout << "- express_latency = " << NoximGlobalParams::
+	express_latency << endl;
+    cout << "- smart_hpc_max = " << NoximGlobalParams::
+	smart_hpc_max << endl;
+    cout << "- deadlock_check_period = " << NoximGlobalParams::
+	deadlock_check_period << endl;
+    cout << "- deadlock_action = " << NoximGlobalParams::
+	deadlock_action << endl;
+    cout << "- link_width = " << NoximGlobalParams::link_width << endl;
+    cout << "- crossbar_speedup = " << NoximGlobalParams::
+	crossbar_speedup << endl;
+    cout << "- pipeline stages (RC SA ST LT) = " << NoximGlobalParams::
+	rc_stages << " " << NoximGlobalParams::sa_stages << " " <<
+	NoximGlobalParams::st_stages << " " << NoximGlobalParams::
+	lt_stages << endl;
+    cout << "- lookahead_routing = " << NoximGlobalParams::
+	lookahead_routing << endl;
+    cout << "- link_latency = " << NoximGlobalParams::
+	link_latency << endl;
+    cout << "- link_pipelining = " << NoximGlobalParams::
+	link_pipelining << endl;
     cout << "- routing_algorithm = " << NoximGlobalParams::
 	routing_algorithm << endl;
     //  cout << "- routing_table_filename = " << NoximGlobalParams::routing_table_filename << endl;
     cout << "- selection_strategy = " << NoximGlobalParams::
 	selection_strategy << endl;
+    cout << "- switch_allocator = " << NoximGlobalParams::
+	switch_allocator << endl;
     cout << "- packet_injection_rate = " << NoximGlobalParams::
 	packet_injection_rate << endl;
     cout << "- probability_of_retransmission = " << NoximGlobalParams::
@@ -146,6 +278,24 @@ void showConfig()
 	traffic_distribution << endl;
     cout << "- simulation_time = " << NoximGlobalParams::
 	simulation_time << endl;
+    cout << "- convergence_precision = " << NoximGlobalParams::
+	convergence_precision << endl;
+    cout << "- convergence_batch = " << NoximGlobalParams::
+	convergence_batch << endl;
+    cout << "- saturation_search_tolerance = " << NoximGlobalParams::
+	saturation_search_tolerance << endl;
+    cout << "- analytic_model = " << NoximGlobalParams::
+	analytic_model << endl;
+    cout << "- mapping_policies =";
+    for (unsigned int i = 0; i < NoximGlobalParams::mapping_policies.size(); i++)
+	cout << " " << NoximGlobalParams::mapping_policies[i];
+    cout << endl;
+    cout << "- mapping_only = " << NoximGlobalParams::mapping_only << endl;
+    cout << "- app_trace_filename = " << NoximGlobalParams::
+	app_trace_filename << endl;
+    cout << "- app_dump_filename = " << NoximGlobalParams::
+	app_dump_filename << endl;
+    cout << "- thermal_model = " << NoximGlobalParams::thermal_model << endl;
     cout << "- stats_warm_up_time = " << NoximGlobalParams::
 	stats_warm_up_time << endl;
     cout << "- rnd_generator_seed = " << NoximGlobalParams::
@@ -164,11 +314,126 @@ void checkInputParameters()
 	exit(1);
     }
 
+    if (NoximGlobalParams::concentration < 1 ||
+	NoximGlobalParams::concentration > MAX_CONCENTRATION) {
+	cerr << "Error: concentration must be in the range [1," <<
+	    MAX_CONCENTRATION << "]" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::chips_x < 1 || NoximGlobalParams::chips_y < 1 ||
+	NoximGlobalParams::mesh_dim_x % NoximGlobalParams::chips_x != 0 ||
+	NoximGlobalParams::mesh_dim_y % NoximGlobalParams::chips_y != 0) {
+	cerr << "Error: chips must split the mesh into chips of the same size" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::chips_x * NoximGlobalParams::chips_y > 1) {
+	if (NoximGlobalParams::topology != TOPOLOGY_MESH ||
+	    NoximGlobalParams::routing_algorithm != ROUTING_XY) {
+	    cerr << "Error: multi-chip systems only support meshes with xy routing" << endl;
+	    exit(1);
+	}
+	if (NoximGlobalParams::virtual_channels > MAX_VIRTUAL_CHANNELS) {
+	    cerr << "Error: chips must be such that CX + CY - 1 <= " <<
+		MAX_VIRTUAL_CHANNELS << " (one virtual channel class per chip crossed)" << endl;
+	    exit(1);
+	}
+	// links between chips side by side sit on the vertical edges
+	if (NoximGlobalParams::chip_links < 1 ||
+	    (NoximGlobalParams::chips_x > 1 &&
+	     NoximGlobalParams::chip_links > chipHeight()) ||
+	    (NoximGlobalParams::chips_y > 1 &&
+	     NoximGlobalParams::chip_links > chipWidth())) {
+	    cerr << "Error: chip links must be in the range [1,chip edge length]" << endl;
+	    exit(1);
+	}
+	if (NoximGlobalParams::chip_link_latency < 1 ||
+	    NoximGlobalParams::chip_link_period < 1) {
+	    cerr << "Error: chip link latency and period must be >= 1" << endl;
+	    exit(1);
+	}
+    }
+
+    if (NoximGlobalParams::express_span != 0) {
+	if (NoximGlobalParams::express_span < 2) {
+	    cerr << "Error: express links must skip at least 2 routers" << endl;
+	    exit(1);
+	}
+	if (NoximGlobalParams::topology != TOPOLOGY_MESH ||
+	    NoximGlobalParams::routing_algorithm != ROUTING_XY ||
+	    NoximGlobalParams::chips_x * NoximGlobalParams::chips_y > 1) {
+	    cerr << "Error: express links are only supported on single-chip meshes with xy routing" << endl;
+	    exit(1);
+	}
+	if (NoximGlobalParams::express_latency < 1) {
+	    cerr << "Error: express latency must be >= 1" << endl;
+	    exit(1);
+	}
+    }
+
+    if (NoximGlobalParams::smart_hpc_max < 1) {
+	cerr << "Error: SMART hops per cycle must be >= 1" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::smart_hpc_max > 1 &&
+	(NoximGlobalParams::topology != TOPOLOGY_MESH ||
+	 NoximGlobalParams::routing_algorithm != ROUTING_XY ||
+	 NoximGlobalParams::chips_x * NoximGlobalParams::chips_y > 1 ||
+	 NoximGlobalParams::express_span > 0 ||
+	 NoximGlobalParams::link_width > 1 ||
+	 NoximGlobalParams::link_latency > 1 ||
+	 NoximGlobalParams::virtual_channels > 1)) {
+	cerr << "Error: SMART bypass needs a single-chip mesh with xy routing, no express links, single-cycle, one flit wide links and a single virtual channel" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::deadlock_check_period < 0) {
+	cerr << "Error: deadlock check period must be >= 0" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::deadlock_action == INVALID_DEADLOCK_ACTION) {
+	cerr << "Error: invalid deadlock action" << endl;
+	exit(1);
+    }
+
     if (NoximGlobalParams::buffer_depth < 1) {
 	cerr << "Error: buffer must be >= 1" << endl;
 	exit(1);
     }
 
+    if (NoximGlobalParams::link_width < 1 ||
+	NoximGlobalParams::link_width > MAX_LINK_WIDTH) {
+	cerr << "Error: link width must be in the range [1," <<
+	    MAX_LINK_WIDTH << "]" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::buffer_depth < NoximGlobalParams::link_width) {
+	cerr << "Error: buffer must be able to hold the flits of a link cycle (>= link width)" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::crossbar_speedup < 1) {
+	cerr << "Error: crossbar speedup must be >= 1" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::rc_stages < 0 ||
+	NoximGlobalParams::sa_stages < 1 ||
+	NoximGlobalParams::st_stages < 0 ||
+	NoximGlobalParams::lt_stages < 0) {
+	cerr << "Error: pipeline stages must be >= 0 (allocation >= 1)" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::link_latency < 1) {
+	cerr << "Error: link latency must be >= 1" << endl;
+	exit(1);
+    }
+
     if (NoximGlobalParams::min_packet_size < 2 ||
 	NoximGlobalParams::max_packet_size < 2) {
 	cerr << "Error: packet size must be >= 2" << endl;
@@ -187,11 +452,50 @@ void checkInputParameters()
 	exit(1);
     }
 
+    if (NoximGlobalParams::topology == INVALID_TOPOLOGY) {
+	cerr << "Error: invalid topology" << endl;
+	exit(1);
+    }
+
+    // The turn models of the adaptive algorithms do not break the
+    // cycles of the rings, only dimension order routing is safe
+    if ((NoximGlobalParams::topology == TOPOLOGY_TORUS ||
+	 NoximGlobalParams::topology == TOPOLOGY_FOLDED_TORUS) &&
+	NoximGlobalParams::routing_algorithm != ROUTING_XY) {
+	cerr << "Error: tori only support xy routing" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::topology == TOPOLOGY_GRAPH) {
+	if (NoximGlobalParams::routing_algorithm != ROUTING_TABLE_BASED) {
+	    cerr << "Error: graph topologies need a routing table" << endl;
+	    exit(1);
+	}
+	if (NoximGlobalParams::selection_strategy == SEL_NOP) {
+	    cerr << "Error: NoP selection is not supported on graph topologies" << endl;
+	    exit(1);
+	}
+	if (NoximGlobalParams::selection_strategy == SEL_RCA) {
+	    cerr << "Error: RCA selection is not supported on graph topologies" << endl;
+	    exit(1);
+	}
+    }
+
     if (NoximGlobalParams::selection_strategy == INVALID_SELECTION) {
 	cerr << "Error: invalid selection policy" << endl;
 	exit(1);
     }
 
+    if (NoximGlobalParams::switch_allocator == INVALID_SWITCH_ALLOC) {
+	cerr << "Error: invalid switch allocator" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::islip_iterations < 1) {
+	cerr << "Error: iSLIP iterations must be >= 1" << endl;
+	exit(1);
+    }
+
     if (NoximGlobalParams::packet_injection_rate <= 0.0 ||
 	NoximGlobalParams::packet_injection_rate > 1.0) {
 	cerr <<
@@ -205,10 +509,14 @@ void checkInputParameters()
 	exit(1);
     }
 
+    for (unsigned int i = 0; i < NoximGlobalParams::mapping_policies.size(); i++)
+	if (NoximGlobalParams::mapping_policies[i] == INVALID_MAPPING) {
+	    cerr << "Error: invalid mapping policy" << endl;
+	    exit(1);
+	}
+
     for (unsigned int i = 0; i < NoximGlobalParams::hotspots.size(); i++) {
-	if (NoximGlobalParams::hotspots[i].first >=
-	    NoximGlobalParams::mesh_dim_x *
-	    NoximGlobalParams::mesh_dim_y) {
+	if (NoximGlobalParams::hotspots[i].first >= peCount()) {
 	    cerr << "Error: hotspot node " << NoximGlobalParams::
 		hotspots[i].first << " is invalid (out of range)" << endl;
 	    exit(1);
@@ -232,6 +540,56 @@ void checkInputParameters()
 	exit(1);
     }
 
+    if (NoximGlobalParams::convergence_precision < 0.0 ||
+	NoximGlobalParams::convergence_precision >= 1.0) {
+	cerr << "Error: convergence precision must be in [0,1)" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::convergence_batch < 1) {
+	cerr << "Error: convergence batch must be >= 1" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::saturation_search_tolerance < 0.0) {
+	cerr << "Error: saturation search tolerance must be positive" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::saturation_search_tolerance > 0.0 &&
+	(NoximGlobalParams::convergence_precision == 0.0 ||
+	 NoximGlobalParams::traffic_distribution == TRAFFIC_TABLE_BASED ||
+	 NoximGlobalParams::traffic_distribution == TRAFFIC_APPLICATION)) {
+	cerr << "Error: saturation search needs -converge and a synthetic traffic distribution" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::analytic_model &&
+	NoximGlobalParams::saturation_search_tolerance > 0.0) {
+	cerr << "Error: -analytic and -satsearch cannot be used together" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::analytic_model &&
+	NoximGlobalParams::traffic_distribution == TRAFFIC_APPLICATION) {
+	cerr << "Error: -analytic does not model the application traffic" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::mapping_only &&
+	(NoximGlobalParams::analytic_model ||
+	 NoximGlobalParams::saturation_search_tolerance > 0.0)) {
+	cerr << "Error: -mappingonly cannot be used with -analytic or -satsearch" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::app_dump_filename[0] != '\0' &&
+	!strcmp(NoximGlobalParams::app_dump_filename,
+		NoximGlobalParams::app_trace_filename)) {
+	cerr << "Error: -appdump would overwrite the trace of -apptrace" << endl;
+	exit(1);
+    }
+
     if (NoximGlobalParams::stats_warm_up_time >
 	NoximGlobalParams::simulation_time) {
 	cerr << "Error: warmup time must be less than simulation time" <<
@@ -250,6 +608,32 @@ void checkInputParameters()
     }
 }
 
+// The routers declared by a topology file are laid out on the most
+// square dimx x dimy matrix, unless -dimx and -dimy already hold them
+void layoutGraph()
+{
+    int routers =
+	NoximGlobalTopology::declaredRouters(NoximGlobalParams::
+					     topology_filename);
+    if (routers == NOT_VALID ||
+	routers == NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y)
+	return;
+
+    int rows = 0;
+    for (int y = 2; y * y <= routers; y++)
+	if (routers % y == 0)
+	    rows = y;
+
+    if (rows == 0 || routers / rows > MAX_STATIC_DIM) {
+	cerr << "Error: " << routers << " routers cannot be laid out on a matrix of 2x2 to " <<
+	    MAX_STATIC_DIM << "x" << MAX_STATIC_DIM << " tiles" << endl;
+	exit(1);
+    }
+
+    NoximGlobalParams::mesh_dim_x = routers / rows;
+    NoximGlobalParams::mesh_dim_y = rows;
+}
+
 //---------------------------------------------------------------------------
 
 void parseCmdLine(int arg_num, char *arg_vet[])
@@ -272,6 +656,56 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 		NoximGlobalParams::mesh_dim_x = atoi(arg_vet[++i]);
 	    else if (!strcmp(arg_vet[i], "-dimy"))
 		NoximGlobalParams::mesh_dim_y = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-topology")) {
+		char *topology = arg_vet[++i];
+		if (!strcmp(topology, "mesh"))
+		    NoximGlobalParams::topology = TOPOLOGY_MESH;
+		else if (!strcmp(topology, "torus"))
+		    NoximGlobalParams::topology = TOPOLOGY_TORUS;
+		else if (!strcmp(topology, "foldedtorus"))
+		    NoximGlobalParams::topology = TOPOLOGY_FOLDED_TORUS;
+		else if (!strcmp(topology, "graph")) {
+		    NoximGlobalParams::topology = TOPOLOGY_GRAPH;
+		    strcpy(NoximGlobalParams::topology_filename,
+			   arg_vet[++i]);
+		} else
+		    NoximGlobalParams::topology = INVALID_TOPOLOGY;
+
+		// tori need the two dateline classes
+		NoximGlobalParams::virtual_channels =
+		    (NoximGlobalParams::topology == TOPOLOGY_TORUS ||
+		     NoximGlobalParams::topology ==
+		     TOPOLOGY_FOLDED_TORUS) ? 2 : 1;
+	    } else if (!strcmp(arg_vet[i], "-concentration"))
+		NoximGlobalParams::concentration = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-chips")) {
+		NoximGlobalParams::chips_x = atoi(arg_vet[++i]);
+		NoximGlobalParams::chips_y = atoi(arg_vet[++i]);
+	    } else if (!strcmp(arg_vet[i], "-chiplinks"))
+		NoximGlobalParams::chip_links = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-chiplatency"))
+		NoximGlobalParams::chip_link_latency = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-chipperiod"))
+		NoximGlobalParams::chip_link_period = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-express"))
+		NoximGlobalParams::express_span = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-expresslatency"))
+		NoximGlobalParams::express_latency = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-smart"))
+		NoximGlobalParams::smart_hpc_max = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-deadlock")) {
+		NoximGlobalParams::deadlock_check_period = atoi(arg_vet[++i]);
+		char *action = arg_vet[++i];
+		if (!strcmp(action, "report"))
+		    NoximGlobalParams::deadlock_action = DEADLOCK_REPORT;
+		else if (!strcmp(action, "abort"))
+		    NoximGlobalParams::deadlock_action = DEADLOCK_ABORT;
+		else if (!strcmp(action, "drain"))
+		    NoximGlobalParams::deadlock_action = DEADLOCK_DRAIN;
+		else
+		    NoximGlobalParams::deadlock_action =
+			INVALID_DEADLOCK_ACTION;
+	    }
 	    else if (!strcmp(arg_vet[i], "-buffer"))
 		NoximGlobalParams::buffer_depth = atoi(arg_vet[++i]);
 	    else if (!strcmp(arg_vet[i], "-size")) {
@@ -316,10 +750,41 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 			SEL_BUFFER_LEVEL;
 		else if (!strcmp(selection, "nop"))
 		    NoximGlobalParams::selection_strategy = SEL_NOP;
+		else if (!strcmp(selection, "rca"))
+		    NoximGlobalParams::selection_strategy = SEL_RCA;
 		else
 		    NoximGlobalParams::selection_strategy =
 			INVALID_SELECTION;
-	    } else if (!strcmp(arg_vet[i], "-pir")) {
+	    } else if (!strcmp(arg_vet[i], "-alloc")) {
+		char *allocator = arg_vet[++i];
+		if (!strcmp(allocator, "rr"))
+		    NoximGlobalParams::switch_allocator =
+			SWITCH_ALLOC_ROUND_ROBIN;
+		else if (!strcmp(allocator, "islip")) {
+		    NoximGlobalParams::switch_allocator = SWITCH_ALLOC_ISLIP;
+		    NoximGlobalParams::islip_iterations = atoi(arg_vet[++i]);
+		} else if (!strcmp(allocator, "wavefront"))
+		    NoximGlobalParams::switch_allocator =
+			SWITCH_ALLOC_WAVEFRONT;
+		else
+		    NoximGlobalParams::switch_allocator =
+			INVALID_SWITCH_ALLOC;
+	    } else if (!strcmp(arg_vet[i], "-linkwidth"))
+		NoximGlobalParams::link_width = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-speedup"))
+		NoximGlobalParams::crossbar_speedup = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-pipeline")) {
+		NoximGlobalParams::rc_stages = atoi(arg_vet[++i]);
+		NoximGlobalParams::sa_stages = atoi(arg_vet[++i]);
+		NoximGlobalParams::st_stages = atoi(arg_vet[++i]);
+		NoximGlobalParams::lt_stages = atoi(arg_vet[++i]);
+	    } else if (!strcmp(arg_vet[i], "-lookahead"))
+		NoximGlobalParams::lookahead_routing = true;
+	    else if (!strcmp(arg_vet[i], "-linklatency"))
+		NoximGlobalParams::link_latency = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-linkpipeline"))
+		NoximGlobalParams::link_pipelining = true;
+	    else if (!strcmp(arg_vet[i], "-pir")) {
 		NoximGlobalParams::packet_injection_rate =
 		    atof(arg_vet[++i]);
 		char *distribution = arg_vet[++i];
@@ -361,6 +826,9 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 		else if (!strcmp(traffic, "shuffle"))
 		    NoximGlobalParams::traffic_distribution =
 			TRAFFIC_SHUFFLE;
+		else if (!strcmp(traffic, "application"))
+		    NoximGlobalParams::traffic_distribution =
+			TRAFFIC_APPLICATION;
 		else if (!strcmp(traffic, "table")) {
 		    NoximGlobalParams::traffic_distribution =
 			TRAFFIC_TABLE_BASED;
@@ -374,7 +842,33 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 		double percentage = atof(arg_vet[++i]);
 		pair < int, double >t(node, percentage);
 		NoximGlobalParams::hotspots.push_back(t);
-	    } else if (!strcmp(arg_vet[i], "-warmup"))
+	    } else if (!strcmp(arg_vet[i], "-mapping")) {
+		char *mapping = arg_vet[++i];
+		int policy;
+		if (!strcmp(mapping, "moc"))
+		    policy = MAPPING_MOC;
+		else if (!strcmp(mapping, "random"))
+		    policy = MAPPING_RANDOM;
+		else if (!strcmp(mapping, "contiguous"))
+		    policy = MAPPING_CONTIGUOUS;
+		else if (!strcmp(mapping, "firstfit"))
+		    policy = MAPPING_FIRST_FIT;
+		else if (!strcmp(mapping, "commaware"))
+		    policy = MAPPING_COMM_AWARE;
+		else
+		    policy = INVALID_MAPPING;
+		NoximGlobalParams::mapping_policies.push_back(policy);
+	    } else if (!strcmp(arg_vet[i], "-mappingonly"))
+		NoximGlobalParams::mapping_only = true;
+	    else if (!strcmp(arg_vet[i], "-apptrace"))
+		strcpy(NoximGlobalParams::app_trace_filename,
+		       arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-appdump"))
+		strcpy(NoximGlobalParams::app_dump_filename,
+		       arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-thermal"))
+		NoximGlobalParams::thermal_model = true;
+	    else if (!strcmp(arg_vet[i], "-warmup"))
 		NoximGlobalParams::stats_warm_up_time = atoi(arg_vet[++i]);
 	    else if (!strcmp(arg_vet[i], "-seed"))
 		NoximGlobalParams::rnd_generator_seed = atoi(arg_vet[++i]);
@@ -385,6 +879,14 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 	    else if (!strcmp(arg_vet[i], "-volume"))
 		NoximGlobalParams::max_volume_to_be_drained =
 		    atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-converge")) {
+		NoximGlobalParams::convergence_precision = atof(arg_vet[++i]);
+		NoximGlobalParams::convergence_batch = atoi(arg_vet[++i]);
+	    } else if (!strcmp(arg_vet[i], "-satsearch"))
+		NoximGlobalParams::saturation_search_tolerance =
+		    atof(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-analytic"))
+		NoximGlobalParams::analytic_model = true;
 	    else if (!strcmp(arg_vet[i], "-sim"))
 		NoximGlobalParams::simulation_time = atoi(arg_vet[++i]);
 	    else if (!strcmp(arg_vet[i], "-pwr"))
@@ -398,8 +900,19 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 		exit(1);
 	    }
 	}
+
+	// multi-chip meshes use a virtual channel class per chip crossed
+	if (NoximGlobalParams::chips_x * NoximGlobalParams::chips_y > 1)
+	    NoximGlobalParams::virtual_channels =
+		NoximGlobalParams::chips_x + NoximGlobalParams::chips_y - 1;
     }
 
+    if (NoximGlobalParams::mapping_policies.empty())
+	NoximGlobalParams::mapping_policies.push_back(DEFAULT_MAPPING_POLICY);
+
+    if (NoximGlobalParams::topology == TOPOLOGY_GRAPH)
+	layoutGraph();
+
     checkInputParameters();
 
     // Show configuration
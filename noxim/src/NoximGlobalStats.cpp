@@ -46,7 +46,7 @@ double NoximGlobalStats::getAverageDelay()
 double NoximGlobalStats::getAverageDelay(const int src_id,
 					 const int dst_id)
 {
-    NoximTile *tile = noc->searchNode(dst_id);
+    NoximTile *tile = noc->searchNode(peRouterId(dst_id));
 
     assert(tile != NULL);
 
@@ -86,7 +86,7 @@ double NoximGlobalStats::getMaxDelay(const int node_id)
 
 double NoximGlobalStats::getMaxDelay(const int src_id, const int dst_id)
 {
-    NoximTile *tile = noc->searchNode(dst_id);
+    NoximTile *tile = noc->searchNode(peRouterId(dst_id));
 
     assert(tile != NULL);
 
@@ -116,7 +116,7 @@ vector < vector < double > > NoximGlobalStats::getMaxDelayMtx()
 double NoximGlobalStats::getAverageThroughput(const int src_id,
 					      const int dst_id)
 {
-    NoximTile *tile = noc->searchNode(dst_id);
+    NoximTile *tile = noc->searchNode(peRouterId(dst_id));
 
     assert(tile != NULL);
 
@@ -171,6 +171,39 @@ unsigned int NoximGlobalStats::getReceivedFlits()
     return n;
 }
 
+unsigned int NoximGlobalStats::getChipReceivedPackets(const bool inter_chip)
+{
+    unsigned int n = 0;
+
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+	    n += noc->t[x][y]->r->stats.getChipReceivedPackets(inter_chip);
+
+    return n;
+}
+
+unsigned int NoximGlobalStats::getChipReceivedFlits(const bool inter_chip)
+{
+    unsigned int n = 0;
+
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+	    n += noc->t[x][y]->r->stats.getChipReceivedFlits(inter_chip);
+
+    return n;
+}
+
+double NoximGlobalStats::getChipAverageDelay(const bool inter_chip)
+{
+    double sum = 0.0;
+
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+	    sum += noc->t[x][y]->r->stats.getChipTotalDelay(inter_chip);
+
+    return sum / (double) getChipReceivedPackets(inter_chip);
+}
+
 double NoximGlobalStats::getThroughput()
 {
     int total_cycles =
@@ -186,8 +219,9 @@ double NoximGlobalStats::getThroughput()
 	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++) {
 	    unsigned int rf = noc->t[x][y]->r->stats.getReceivedFlits();
 
+	    // flits received by a router are shared by its PEs
 	    if (rf != 0)
-		n++;
+		n += NoximGlobalParams::concentration;
 
 	    trf += rf;
 	}
@@ -211,6 +245,28 @@ vector < vector < unsigned long > > NoximGlobalStats::getRoutedFlitsMtx()
     return mtx;
 }
 
+unsigned long NoximGlobalStats::getBypassedFlits()
+{
+    unsigned long n = 0;
+
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+	    n += noc->t[x][y]->r->getBypassedFlits();
+
+    return n;
+}
+
+unsigned long NoximGlobalStats::getDroppedFlits()
+{
+    unsigned long n = 0;
+
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+	    n += noc->t[x][y]->r->getDroppedFlits();
+
+    return n;
+}
+
 double NoximGlobalStats::getPower()
 {
     double power = 0.0;
@@ -222,6 +278,23 @@ double NoximGlobalStats::getPower()
     return power;
 }
 
+double NoximGlobalStats::getSwitchAllocatorEfficiency()
+{
+    unsigned long grants = 0;
+    unsigned long max_grants = 0;
+
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++) {
+	    grants += noc->t[x][y]->r->switch_allocator.getGrants();
+	    max_grants += noc->t[x][y]->r->switch_allocator.getMaxGrants();
+	}
+
+    if (max_grants == 0)
+	return 1.0;
+
+    return (double) grants / (double) max_grants;
+}
+
 void NoximGlobalStats::showStats(std::ostream & out, bool detailed)
 {
     out << "% Total received packets: " << getReceivedPackets() << endl;
@@ -233,6 +306,48 @@ void NoximGlobalStats::showStats(std::ostream & out, bool detailed)
     out << "% Throughput (flits/cycle/IP): " << getThroughput() << endl;
     out << "% Max delay (cycles): " << getMaxDelay() << endl;
     out << "% Total energy (J): " << getPower() << endl;
+    out << "% Switch allocator efficiency: " <<
+	getSwitchAllocatorEfficiency() << endl;
+
+    if (NoximGlobalParams::smart_hpc_max > 1)
+	out << "% Bypassed router traversals: " << getBypassedFlits() <<
+	    endl;
+
+    if (NoximGlobalParams::convergence_precision > 0.0) {
+	out << "% Convergence: ";
+	if (noc->convergence == CONVERGENCE_REACHED)
+	    out << "reached";
+	else if (noc->convergence == CONVERGENCE_UNSTABLE)
+	    out << "unstable (saturated)";
+	else
+	    out << "not reached";
+	out << " after " << noc->batch_throughputs.size() << " batches" << endl;
+	out << "% Delay relative precision: " << noc->delay_precision << endl;
+	out << "% Throughput relative precision: " <<
+	    noc->throughput_precision << endl;
+    }
+
+    if (NoximGlobalParams::deadlock_check_period > 0 && noc->deadlocks > 0) {
+	out << "% Deadlocks detected: " << noc->deadlocks << endl;
+	if (NoximGlobalParams::deadlock_action == DEADLOCK_DRAIN)
+	    out << "% Flits dropped by deadlock recovery: " <<
+		getDroppedFlits() << endl;
+    }
+
+    if (NoximGlobalParams::chips_x * NoximGlobalParams::chips_y > 1) {
+	out << "% Intra-chip received packets: " <<
+	    getChipReceivedPackets(false) << endl;
+	out << "% Intra-chip received flits: " <<
+	    getChipReceivedFlits(false) << endl;
+	out << "% Intra-chip average delay (cycles): " <<
+	    getChipAverageDelay(false) << endl;
+	out << "% Inter-chip received packets: " <<
+	    getChipReceivedPackets(true) << endl;
+	out << "% Inter-chip received flits: " <<
+	    getChipReceivedFlits(true) << endl;
+	out << "% Inter-chip average delay (cycles): " <<
+	    getChipAverageDelay(true) << endl;
+    }
 
     if (NoximGlobalParams::show_buffer_stats)
       showBufferStats(out);
@@ -270,14 +385,35 @@ void NoximGlobalStats::showStats(std::ostream & out, bool detailed)
 	    out << endl;
 	}
 	out << "];" << endl;
+
+	// show switch allocator efficiency matrix
+	out << endl << "allocator_efficiency = [" << endl;
+	for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++) {
+	    out << "   ";
+	    for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+		out << setw(10) << noc->t[x][y]->r->switch_allocator.
+		    getEfficiency();
+	    out << endl;
+	}
+	out << "];" << endl;
     }
 }
 
 
 void NoximGlobalStats::showBufferStats(std::ostream & out)
 {
-  out << "Router id\tBuffer N\t\tBuffer E\t\tBuffer S\t\tBuffer W\t\tBuffer L" << endl;
-  out << "         \tMean\tMax\tMean\tMax\tMean\tMax\tMean\tMax\tMean\tMax" << endl;
+  out << "Router id\tBuffer N\t\tBuffer E\t\tBuffer S\t\tBuffer W\t\tBuffer L";
+  for (int k = 1; k < NoximGlobalParams::concentration; k++)
+    out << "\t\tBuffer L" << k;
+  if (NoximGlobalParams::express_span > 0)
+    out << "\t\tBuffer XN\t\tBuffer XE\t\tBuffer XS\t\tBuffer XW";
+  out << endl;
+  out << "         \tMean\tMax\tMean\tMax\tMean\tMax\tMean\tMax\tMean\tMax";
+  for (int k = 1; k < NoximGlobalParams::concentration; k++)
+    out << "\tMean\tMax";
+  if (NoximGlobalParams::express_span > 0)
+    out << "\tMean\tMax\tMean\tMax\tMean\tMax\tMean\tMax";
+  out << endl;
   for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
     for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
       {
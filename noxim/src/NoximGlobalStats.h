@@ -57,15 +57,32 @@ class NoximGlobalStats {
     // Returns the total number of received flits
     unsigned int getReceivedFlits();
 
+    // Multi-chip meshes: totals for the packets that crossed at least
+    // one chip boundary (inter_chip) or stayed inside their chip
+    unsigned int getChipReceivedPackets(const bool inter_chip);
+    unsigned int getChipReceivedFlits(const bool inter_chip);
+    double getChipAverageDelay(const bool inter_chip);
+
     // Returns the maximum value of the accepted traffic
     double getThroughput();
 
     // Returns the number of routed flits for each router
      vector < vector < unsigned long > > getRoutedFlitsMtx();
 
+    // Returns the number of times a flit went straight through a
+    // router without stopping in it (SMART bypass)
+    unsigned long getBypassedFlits();
+
+    // Returns the number of flits dropped to recover from deadlocks
+    unsigned long getDroppedFlits();
+
     // Returns the total power
     double getPower();
 
+    // Returns the ratio between the grants issued by the switch
+    // allocators and the size of the maximum matchings of their requests
+    double getSwitchAllocatorEfficiency();
+
     // Shows global statistics
     void showStats(std::ostream & out = std::cout, bool detailed = false);
 
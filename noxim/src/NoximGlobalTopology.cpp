@@ -0,0 +1,187 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the global topology
+ */
+
+#include "NoximGlobalTopology.h"
+
+NoximGlobalTopology::NoximGlobalTopology()
+{
+    valid = false;
+}
+
+bool NoximGlobalTopology::load(const char *fname)
+{
+    ifstream fin(fname, ios::in);
+
+    if (!fin)
+	return false;
+
+    // The graph has a router for each tile of the dimx x dimy matrix,
+    // which the command line has laid out to hold the routers declared
+    // by the file. A node gets its ports as the links use them.
+    int nodes = NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y;
+    links.assign(nodes, vector < NoximTopologyLink > ());
+
+    char line[512];
+    while (fin.getline(line, sizeof(line))) {
+	if (line[0] == '\0' || line[0] == '%')
+	    continue;
+
+	// routers N
+	int routers;
+	if (sscanf(line, "routers %d", &routers) == 1) {
+	    if (routers != nodes) {
+		cerr << "Error: the topology has " << routers <<
+		    " routers but the NoC has " << nodes << endl;
+		return false;
+	    }
+	    continue;
+	}
+
+	// link ROUTER_A PORT_A ROUTER_B PORT_B [LATENCY]
+	int a, port_a, b, port_b, latency;
+	int params = sscanf(line, "link %d %d %d %d %d", &a, &port_a, &b,
+			    &port_b, &latency);
+	if (params < 4) {
+	    cerr << "Error: malformed line in topology file: " << line << endl;
+	    return false;
+	}
+	if (params < 5)
+	    latency = NoximGlobalParams::link_latency;
+
+	if (a < 0 || a >= nodes || b < 0 || b >= nodes || a == b) {
+	    cerr << "Error: link " << a << "-" << b <<
+		" must connect two different routers in [0," << nodes -
+		1 << "]" << endl;
+	    return false;
+	}
+
+	if (latency < 1) {
+	    cerr << "Error: latency of link " << a << "-" << b <<
+		" must be >= 1" << endl;
+	    return false;
+	}
+
+	// Routing tables identify channels by their end points
+	for (int p = 0; p < getDegree(a); p++)
+	    if (links[a][p].neighbor == b) {
+		cerr << "Error: routers " << a << " and " << b <<
+		    " are connected twice" << endl;
+		return false;
+	    }
+
+	if (!connect(a, port_a, b, port_b, latency)
+	    || !connect(b, port_b, a, port_a, latency))
+	    return false;
+    }
+
+    // getline stops before the end of the file on a line longer than
+    // the buffer
+    if (!fin.eof()) {
+	cerr << "Error: line too long in topology file" << endl;
+	return false;
+    }
+
+    valid = true;
+
+    return true;
+}
+
+bool NoximGlobalTopology::connect(const int node, const int port,
+				  const int neighbor,
+				  const int neighbor_port,
+				  const int latency)
+{
+    if (port < 0 || port >= MAX_GRAPH_PORTS) {
+	cerr << "Error: router " << node << " has no port " << port <<
+	    " (ports are numbered from 0 to " << MAX_GRAPH_PORTS - 1 << ")" <<
+	    endl;
+	return false;
+    }
+
+    if (port >= getDegree(node)) {
+	NoximTopologyLink unused;
+	unused.neighbor = NOT_VALID;
+	unused.neighbor_port = NOT_VALID;
+	unused.latency = 0;
+	links[node].resize(port + 1, unused);
+    }
+
+    if (links[node][port].neighbor != NOT_VALID) {
+	cerr << "Error: port " << port << " of router " << node <<
+	    " is used twice" << endl;
+	return false;
+    }
+
+    links[node][port].neighbor = neighbor;
+    links[node][port].neighbor_port = neighbor_port;
+    links[node][port].latency = latency;
+
+    return true;
+}
+
+int NoximGlobalTopology::declaredRouters(const char *fname)
+{
+    ifstream fin(fname, ios::in);
+
+    char line[512];
+    int routers;
+    while (fin.getline(line, sizeof(line)))
+	if (sscanf(line, "routers %d", &routers) == 1)
+	    return routers;
+
+    return NOT_VALID;
+}
+
+int NoximGlobalTopology::getNeighbor(const int node_id, const int port) const
+{
+    assert(valid);
+
+    if (port >= getDegree(node_id))
+	return NOT_VALID;
+
+    return links[node_id][port].neighbor;
+}
+
+int NoximGlobalTopology::getNeighborPort(const int node_id,
+					 const int port) const
+{
+    assert(valid);
+
+    if (port >= getDegree(node_id))
+	return NOT_VALID;
+
+    return links[node_id][port].neighbor_port;
+}
+
+int NoximGlobalTopology::getLatency(const int node_id, const int port) const
+{
+    assert(valid);
+
+    if (port >= getDegree(node_id))
+	return 0;
+
+    return links[node_id][port].latency;
+}
+
+int NoximGlobalTopology::getPorts(const int node_id) const
+{
+    int ports = 0;
+
+    for (int p = 0; p < getDegree(node_id); p++)
+	if (getNeighbor(node_id, p) != NOT_VALID)
+	    ports++;
+
+    return ports;
+}
+
+int NoximGlobalTopology::getDegree(const int node_id) const
+{
+    return links[node_id].size();
+}
@@ -0,0 +1,69 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the global topology
+ */
+
+#ifndef __NOXIMGLOBALTOPOLOGY_H__
+#define __NOXIMGLOBALTOPOLOGY_H__
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "NoximMain.h"
+using namespace std;
+
+// End of a link as seen from one of the routers it connects
+struct NoximTopologyLink {
+    int neighbor;		// ID of the router on the other side
+    int neighbor_port;		// Port of the neighbor the link lands on
+    int latency;		// Cycles needed to cross the link
+};
+
+class NoximGlobalTopology {
+
+  public:
+
+    NoximGlobalTopology();
+
+    // Load the router graph from file. Returns true if ok, false
+    // otherwise
+    bool load(const char *fname);
+
+    // Number of routers declared by the file, NOT_VALID if it does not
+    // declare them
+    static int declaredRouters(const char *fname);
+
+    // Router connected to port of node_id, NOT_VALID if the port is
+    // not used
+    int getNeighbor(const int node_id, const int port) const;
+
+    // Port of the neighbor on which the link of port lands
+    int getNeighborPort(const int node_id, const int port) const;
+
+    // Latency of the link connected to port of node_id
+    int getLatency(const int node_id, const int port) const;
+
+    // Number of network ports actually used by node_id
+    int getPorts(const int node_id) const;
+
+    // Network ports of node_id: the highest one linked plus one
+    int getDegree(const int node_id) const;
+
+    bool isValid() {
+	return valid;
+  } private:
+
+     vector < vector < NoximTopologyLink > > links;	// links[node][port], as many ports as each node uses
+    bool valid;
+
+    bool connect(const int node, const int port, const int neighbor,
+		 const int neighbor_port, const int latency);
+};
+
+#endif
@@ -137,3 +137,34 @@ int NoximGlobalTrafficTable::occurrencesAsSource(const int src_id)
 
   return count;
 }
+
+vector < pair < int, double > > NoximGlobalTrafficTable::getAverageRates(const int src_id)
+{
+  vector < pair < int, double > > rates;
+
+  for (unsigned int i = 0; i < traffic_table.size(); i++) {
+    NoximCommunication comm = traffic_table[i];
+    if (comm.src != src_id)
+      continue;
+
+    // cycles of the run in which the communication is active
+    int active = 0;
+    for (int c = DEFAULT_RESET_TIME;
+	 c < DEFAULT_RESET_TIME + NoximGlobalParams::simulation_time; c++) {
+      int r_ccycle = c % comm.t_period;
+      if (r_ccycle > comm.t_on && r_ccycle < comm.t_off)
+	active++;
+    }
+
+    // while active, a packet follows another one with probability por
+    // and an idle cycle with probability pir
+    double rate = 0.0;
+    if (comm.pir > 0.0)
+      rate = comm.pir / (1.0 - comm.por + comm.pir) * active /
+	NoximGlobalParams::simulation_time;
+
+    rates.push_back(pair < int, double >(comm.dst, rate));
+  }
+
+  return rates;
+}
@@ -51,6 +51,11 @@ class NoximGlobalTrafficTable {
     // table
     int occurrencesAsSource(const int src_id);
 
+    // Returns the average number of packets per cycle src_id sends to
+    // each of its destinations over the simulated cycles, as pairs of
+    // destination and rate
+    vector < pair < int, double > > getAverageRates(const int src_id);
+
   private:
 
      vector < NoximCommunication > traffic_table;
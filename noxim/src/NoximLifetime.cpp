@@ -0,0 +1,233 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the lifetime state of the PEs
+ */
+
+#include "NoximLifetime.h"
+
+NoximLifetime::NoximLifetime()
+{
+    listener = NULL;
+    configure(0);
+}
+
+void NoximLifetime::configure(const int _n_pes)
+{
+    n_pes = _n_pes;
+
+    budget.resize(n_pes);
+    charged_since.resize(n_pes);
+    wear.resize(n_pes);
+    active.resize(n_pes);
+    refilled.resize(n_pes);
+    price.resize(n_pes);
+    enabled.resize(n_pes);
+    occupied.resize(n_pes);
+    app.resize(n_pes);
+    end.resize(n_pes);
+
+    reset(0.0);
+}
+
+void NoximLifetime::reset(const double start)
+{
+    time = start;
+    busy_cores = 0;
+
+    // Refills happen in the last cycle of every INTERVAL
+    int c = (int) start;
+    next_refill = c + (INTERVAL - 1 - c % INTERVAL);
+
+    budget.assign(n_pes, 0.0);
+    charged_since.assign(n_pes, start);
+    wear.assign(n_pes, 1.0);
+    active.assign(n_pes, 0.0);
+    refilled.assign(n_pes, 0.0);
+    price.assign(n_pes, 0.0);
+    enabled.assign(n_pes, true);
+    occupied.assign(n_pes, false);
+    app.assign(n_pes, 0);
+    end.assign(n_pes, 0);
+
+    // without a price nobody is for hire
+    free_cores.configure(n_pes);
+}
+
+void NoximLifetime::advanceTo(const double now)
+{
+    assert(now >= time);
+
+    while (next_refill <= now) {
+	time = next_refill;
+	refill();
+	next_refill += INTERVAL;
+    }
+
+    time = now;
+}
+
+double NoximLifetime::getTime() const
+{
+    return time;
+}
+
+double NoximLifetime::getNextRefill() const
+{
+    return next_refill;
+}
+
+void NoximLifetime::charge(const int id)
+{
+    if (occupied[id]) {
+	budget[id] -= LC * wear[id] * (time - charged_since[id]);
+	active[id] += time - charged_since[id];
+    }
+    charged_since[id] = time;
+}
+
+void NoximLifetime::refill()
+{
+    // The PEs that have been free since the last refill keep their
+    // order in the index, which moves as a whole: only the others are
+    // put back in it
+    free_cores.raise(LN * INTERVAL);
+
+    // The budgets are brought to the refill cycle in a single pass over
+    // the arrays; the cycle itself is charged afterwards, as before
+    for (int i = 0; i < n_pes; i++) {
+	if (occupied[i]) {
+	    budget[i] -= LC * wear[i] * (time - charged_since[i]);
+	    active[i] += time - charged_since[i];
+	}
+	charged_since[i] = time;
+	budget[i] += LN * INTERVAL;
+	enabled[i] = budget[i] >= 0;
+	refilled[i] = budget[i];
+	price[i] = 1 / budget[i];
+
+	if (!occupied[i] && !(free_cores.contains(i) &&
+			      free_cores.getBudget(i) == refilled[i]))
+	    updatePriceIndex(i);
+    }
+
+    if (listener)
+	listener->pricesChanged();
+}
+
+void NoximLifetime::setListener(NoximLifetimeListener * _listener)
+{
+    listener = _listener;
+}
+
+void NoximLifetime::mapTask(const int id, const int _app, const int _end)
+{
+    assert(id >= 0 && id < n_pes);
+
+    charge(id);
+    if (!occupied[id])
+	busy_cores++;
+    app[id] = _app;
+    end[id] = _end;
+    occupied[id] = true;
+    updatePriceIndex(id);
+
+    if (listener)
+	listener->occupancyChanged(id);
+}
+
+void NoximLifetime::clearTask(const int id)
+{
+    assert(id >= 0 && id < n_pes);
+
+    charge(id);
+    if (occupied[id])
+	busy_cores--;
+    app[id] = 0;
+    end[id] = 0;
+    occupied[id] = false;
+    updatePriceIndex(id);
+
+    if (listener)
+	listener->occupancyChanged(id);
+}
+
+void NoximLifetime::updatePriceIndex(const int id)
+{
+    // only the free PEs with some budget left can be hired
+    if (!occupied[id] && price[id] > 0)
+	free_cores.update(id, refilled[id]);
+    else
+	free_cores.erase(id);
+}
+
+bool NoximLifetime::isOccupied(const int id) const
+{
+    return occupied[id];
+}
+
+int NoximLifetime::getBusyCores() const
+{
+    return busy_cores;
+}
+
+bool NoximLifetime::isEnabled(const int id) const
+{
+    return enabled[id];
+}
+
+int NoximLifetime::getApp(const int id) const
+{
+    return app[id];
+}
+
+int NoximLifetime::getEnd(const int id) const
+{
+    return end[id];
+}
+
+double NoximLifetime::getPrice(const int id) const
+{
+    return price[id];
+}
+
+double NoximLifetime::getBudget(const int id) const
+{
+    if (occupied[id])
+	return budget[id] - LC * wear[id] * (time + 1 - charged_since[id]);
+
+    return budget[id];
+}
+
+const NoximPriceIndex & NoximLifetime::freeCores() const
+{
+    return free_cores;
+}
+
+void NoximLifetime::setWear(const int id, const double factor)
+{
+    assert(id >= 0 && id < n_pes);
+
+    charge(id);
+    wear[id] = factor;
+}
+
+double NoximLifetime::getActiveCycles(const int id) const
+{
+    if (occupied[id])
+	return active[id] + time - charged_since[id];
+
+    return active[id];
+}
+
+void NoximLifetime::clearActiveCycles()
+{
+    for (int i = 0; i < n_pes; i++) {
+	charge(i);
+	active[i] = 0.0;
+    }
+}
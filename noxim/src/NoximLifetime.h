@@ -0,0 +1,111 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the lifetime state of the PEs
+ */
+
+#ifndef __NOXIMLIFETIME_H__
+#define __NOXIMLIFETIME_H__
+
+#include <cassert>
+#include <vector>
+#include "NoximMain.h"
+#include "NoximPriceIndex.h"
+using namespace std;
+
+// NoximLifetimeListener -- Told when a PE gets busy or free and when
+// the prices change, to keep what is built on them up to date
+class NoximLifetimeListener {
+  public:
+    virtual ~NoximLifetimeListener() {}
+    virtual void occupancyChanged(const int id) = 0;
+    virtual void pricesChanged() = 0;
+};
+
+// Lifetime budget, price and task of every PE, one array per field.
+// A budget only changes linearly between two events (a task starting
+// or ending on the PE and the refill every INTERVAL cycles), so it is
+// brought up to date at the events instead of in every cycle.
+class NoximLifetime {
+  public:
+
+    NoximLifetime();
+
+    // Sets the number of PEs and resets them
+    void configure(const int _n_pes);
+
+    // Every PE gets free, with no budget and no price. The first
+    // refill is the first one after cycle start.
+    void reset(const double start);
+
+    // Applies the refills due up to cycle now, included. The time
+    // never goes backwards.
+    void advanceTo(const double now);
+    double getTime() const;
+    double getNextRefill() const;
+
+    // The listener, if any, is not owned
+    void setListener(NoximLifetimeListener * _listener);
+
+    // PE id runs application app until cycle end
+    void mapTask(const int id, const int app, const int end);
+    void clearTask(const int id);
+
+    bool isOccupied(const int id) const;
+    int getBusyCores() const;	// PEs running a task
+    bool isEnabled(const int id) const;
+    int getApp(const int id) const;
+    int getEnd(const int id) const;
+    double getPrice(const int id) const;
+
+    // Budget at the end of the current cycle
+    double getBudget(const int id) const;
+
+    // The free PEs with a positive price, which can be hired
+    const NoximPriceIndex & freeCores() const;
+
+    // From the current cycle on, PE id is charged LC * factor per cycle
+    // while busy
+    void setWear(const int id, const double factor);
+
+    // Cycles PE id has run a task for since the last
+    // clearActiveCycles(), up to the current one
+    double getActiveCycles(const int id) const;
+    void clearActiveCycles();
+
+  private:
+
+    int n_pes;
+    double time;		// Cycle of the last advanceTo()
+    double next_refill;		// Cycle of the next refill
+    int busy_cores;
+
+    vector <double> budget;	// Budget at cycle charged_since
+    vector <double> charged_since;
+    vector <double> wear;	// Of LC, 1 but for the thermal model
+    vector <double> active;	// Busy cycles charged since the last clear
+    vector <double> refilled;	// Budget at the last refill
+    vector <double> price;	// The inverse of refilled
+    vector <char> enabled;	// The budget is not negative
+    vector <char> occupied;
+    vector <int> app;		// Application running on the PE
+    vector <int> end;		// Cycle the application ends at
+
+    NoximPriceIndex free_cores;
+    NoximLifetimeListener *listener;
+
+    // Charges the cycles PE id has been running for since the last
+    // charge
+    void charge(const int id);
+
+    // Adds LN * INTERVAL to every budget at cycle next_refill
+    void refill();
+
+    void updatePriceIndex(const int id);
+};
+
+#endif
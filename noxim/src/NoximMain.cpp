@@ -11,6 +11,7 @@
 #include "NoximMain.h"
 #include "NoximNoC.h"
 #include "NoximGlobalStats.h"
+#include "NoximAnalyticModel.h"
 #include "NoximCmdLineParser.h"
 using namespace std;
 
@@ -29,6 +30,8 @@ int NoximGlobalParams::max_packet_size = DEFAULT_MAX_PACKET_SIZE;
 int NoximGlobalParams::routing_algorithm = DEFAULT_ROUTING_ALGORITHM;
 char NoximGlobalParams::routing_table_filename[128] = DEFAULT_ROUTING_TABLE_FILENAME;
 int NoximGlobalParams::selection_strategy = DEFAULT_SELECTION_STRATEGY;
+int NoximGlobalParams::switch_allocator = DEFAULT_SWITCH_ALLOCATOR;
+int NoximGlobalParams::islip_iterations = DEFAULT_ISLIP_ITERATIONS;
 float NoximGlobalParams::packet_injection_rate = DEFAULT_PACKET_INJECTION_RATE;
 float NoximGlobalParams::probability_of_retransmission = DEFAULT_PROBABILITY_OF_RETRANSMISSION;
 int NoximGlobalParams::traffic_distribution = DEFAULT_TRAFFIC_DISTRIBUTION;
@@ -39,14 +42,212 @@ int NoximGlobalParams::rnd_generator_seed = time(NULL);
 bool NoximGlobalParams::detailed = DEFAULT_DETAILED;
 float NoximGlobalParams::dyad_threshold = DEFAULT_DYAD_THRESHOLD;
 unsigned int NoximGlobalParams::max_volume_to_be_drained = DEFAULT_MAX_VOLUME_TO_BE_DRAINED;
+double NoximGlobalParams::convergence_precision = DEFAULT_CONVERGENCE_PRECISION;
+int NoximGlobalParams::convergence_batch = DEFAULT_CONVERGENCE_BATCH;
+double NoximGlobalParams::saturation_search_tolerance = DEFAULT_SATURATION_SEARCH_TOLERANCE;
+bool NoximGlobalParams::analytic_model = DEFAULT_ANALYTIC_MODEL;
 vector <pair <int, double> > NoximGlobalParams::hotspots;
+vector <int> NoximGlobalParams::mapping_policies;
+bool NoximGlobalParams::mapping_only = DEFAULT_MAPPING_ONLY;
+char NoximGlobalParams::app_trace_filename[128] = DEFAULT_APP_TRACE_FILENAME;
+char NoximGlobalParams::app_dump_filename[128] = DEFAULT_APP_DUMP_FILENAME;
+bool NoximGlobalParams::thermal_model = DEFAULT_THERMAL_MODEL;
 char NoximGlobalParams::router_power_filename[128] = DEFAULT_ROUTER_PWR_FILENAME;
 bool NoximGlobalParams::low_power_link_strategy = DEFAULT_LOW_POWER_LINK_STRATEGY;
 double NoximGlobalParams::qos = DEFAULT_QOS;
 bool NoximGlobalParams::show_buffer_stats = DEFAULT_SHOW_BUFFER_STATS;
+int NoximGlobalParams::link_width = DEFAULT_LINK_WIDTH;
+int NoximGlobalParams::crossbar_speedup = DEFAULT_CROSSBAR_SPEEDUP;
+int NoximGlobalParams::rc_stages = DEFAULT_RC_STAGES;
+int NoximGlobalParams::sa_stages = DEFAULT_SA_STAGES;
+int NoximGlobalParams::st_stages = DEFAULT_ST_STAGES;
+int NoximGlobalParams::lt_stages = DEFAULT_LT_STAGES;
+bool NoximGlobalParams::lookahead_routing = DEFAULT_LOOKAHEAD_ROUTING;
+int NoximGlobalParams::topology = DEFAULT_TOPOLOGY;
+char NoximGlobalParams::topology_filename[128] = DEFAULT_TOPOLOGY_FILENAME;
+int NoximGlobalParams::virtual_channels = DEFAULT_VIRTUAL_CHANNELS;
+int NoximGlobalParams::concentration = DEFAULT_CONCENTRATION;
+int NoximGlobalParams::link_latency = DEFAULT_LINK_LATENCY;
+bool NoximGlobalParams::link_pipelining = DEFAULT_LINK_PIPELINING;
+int NoximGlobalParams::chips_x = DEFAULT_CHIPS_X;
+int NoximGlobalParams::chips_y = DEFAULT_CHIPS_Y;
+int NoximGlobalParams::chip_links = DEFAULT_CHIP_LINKS;
+int NoximGlobalParams::chip_link_latency = DEFAULT_CHIP_LINK_LATENCY;
+int NoximGlobalParams::chip_link_period = DEFAULT_CHIP_LINK_PERIOD;
+int NoximGlobalParams::express_span = DEFAULT_EXPRESS_SPAN;
+int NoximGlobalParams::express_latency = DEFAULT_EXPRESS_LATENCY;
+int NoximGlobalParams::smart_hpc_max = DEFAULT_SMART_HPC_MAX;
+int NoximGlobalParams::deadlock_check_period = DEFAULT_DEADLOCK_CHECK_PERIOD;
+int NoximGlobalParams::deadlock_action = DEFAULT_DEADLOCK_ACTION;
                                   
 //---------------------------------------------------------------------------
 
+// Changes the injection rate of the running simulation. Bursty
+// distributions keep their retransmission to injection ratio.
+static void setInjectionRate(const double pir)
+{
+    NoximGlobalParams::probability_of_retransmission *=
+	pir / NoximGlobalParams::packet_injection_rate;
+    NoximGlobalParams::packet_injection_rate = pir;
+}
+
+static double mean(const vector <double> & samples)
+{
+    double sum = 0.0;
+    for (unsigned int i = 0; i < samples.size(); i++)
+	sum += samples[i];
+
+    return samples.empty() ? 0.0 : sum / samples.size();
+}
+
+// Runs the network at injection rate pir, from the state left by the
+// previous probe, until the convergence detection settles or for at
+// most -sim cycles. Returns the outcome and the batch means. Near zero
+// load the throughput is too noisy to wait for, only the delay counts.
+static int probe(NoximNoC * n, const double pir, double &delay,
+		 double &throughput, const bool zero_load = false)
+{
+    setInjectionRate(pir);
+    n->restartConvergence();
+
+    int cycles = 0;
+    while (n->convergence == CONVERGENCE_RUNNING &&
+	   cycles < NoximGlobalParams::simulation_time) {
+	sc_start(NoximGlobalParams::convergence_batch, SC_NS);
+	cycles += NoximGlobalParams::convergence_batch;
+
+	if (zero_load &&
+	    (int) n->batch_delays.size() >= CONVERGENCE_MIN_BATCHES &&
+	    n->delay_precision <= NoximGlobalParams::convergence_precision)
+	    n->convergence = CONVERGENCE_REACHED;
+    }
+
+    delay = mean(n->batch_delays);
+    throughput = mean(n->batch_throughputs);
+
+    cout << "Probe pir " << pir << ": ";
+    if (n->convergence == CONVERGENCE_REACHED)
+	cout << "converged";
+    else if (n->convergence == CONVERGENCE_UNSTABLE)
+	cout << "unstable";
+    else
+	cout << "not converged";
+    cout << " after " << cycles << " cycles, delay " << delay <<
+	", throughput " << throughput << endl;
+
+    return n->convergence;
+}
+
+// Drops the packets piled up in the PEs by a saturated probe
+static void flushSourceQueues(NoximNoC * n)
+{
+    for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++)
+	for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++)
+	    for (int k = 0; k < NoximGlobalParams::concentration; k++)
+		n->t[i][j]->pe[k]->flushQueue();
+}
+
+// Looks for the highest injection rate the network sustains: the rate
+// is doubled from -pir until a probe saturates, then the interval is
+// bisected down to the requested tolerance. The network is never reset,
+// each probe starts from the state warmed up by the previous one.
+static void saturationSearch(NoximNoC * n, ostream & out)
+{
+    double tolerance = NoximGlobalParams::saturation_search_tolerance;
+    double pir = NoximGlobalParams::packet_injection_rate;
+    int probes = 0;
+    double delay, throughput;
+
+    // Zero-load latency, at a small fraction of the starting rate
+    double lo = pir * ZERO_LOAD_PIR_FRACTION;
+    setInjectionRate(lo);
+    sc_start(NoximGlobalParams::stats_warm_up_time, SC_NS);
+
+    double zero_load_delay;
+    double lo_throughput;
+    int outcome = probe(n, lo, zero_load_delay, lo_throughput, true);
+    probes++;
+
+    if (outcome == CONVERGENCE_UNSTABLE) {
+	out << "% Saturation search: the network is saturated at pir " <<
+	    lo << ", try a lower -pir" << endl;
+	return;
+    }
+
+    double hi = 0.0;		// lowest saturated rate, when known
+    while (hi == 0.0 || hi - lo > tolerance * lo) {
+	if (hi == 0.0 && pir > 1.0)
+	    break;
+
+	outcome = probe(n, pir, delay, throughput);
+	probes++;
+
+	// a probe that did not settle within -sim cycles still counts as
+	// sustained as long as its delay neither diverges nor blows up
+	if (outcome != CONVERGENCE_UNSTABLE &&
+	    delay <= SATURATION_DELAY_FACTOR * zero_load_delay) {
+	    lo = pir;
+	    lo_throughput = throughput;
+	} else {
+	    hi = pir;
+	    flushSourceQueues(n);
+	}
+
+	pir = hi == 0.0 ? 2.0 * pir : (lo + hi) / 2.0;
+    }
+
+    out << "% Saturation search probes: " << probes << endl;
+    out << "% Cycles simulated: " << sc_time_stamp().to_double() / 1000 <<
+	endl;
+    out << "% Zero-load latency (cycles): " << zero_load_delay << endl;
+    if (hi == 0.0)
+	out << "% Saturation injection rate: not reached up to 1" << endl;
+    else
+	out << "% Saturation injection rate: " << lo << " (saturated at " <<
+	    hi << ")" << endl;
+    out << "% Saturation throughput (flits/cycle): " << lo_throughput <<
+	endl;
+}
+
+// Statistics of every mapper and budgets of the PEs of the first one
+static void showMapping(const vector <NoximMapper *> & mappers)
+{
+    for (unsigned int i = 0; i < mappers.size(); i++)
+	mappers[i]->showStats(std::cout);
+
+    const NoximLifetime & lifetime = mappers[0]->lifetime;
+    for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++) {
+	    for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
+	    	for (int k = 0; k < NoximGlobalParams::concentration; k++)
+	    		cout << lifetime.getBudget((j * NoximGlobalParams::mesh_dim_x + i) *
+	    				NoximGlobalParams::concentration + k) <<"\t";
+	    }
+	    cout << endl;
+	}
+}
+
+// The mapping layer alone, driven by its events: the same cycles the
+// regular run would simulate, without a network
+static void runMappingOnly()
+{
+    vector <NoximMapper *> mappers;
+    for (unsigned int i = 0; i < NoximGlobalParams::mapping_policies.size(); i++)
+	mappers.push_back(new NoximMapper(NoximAppTrace::create(),
+		NoximMappingPolicy::create(NoximGlobalParams::mapping_policies[i])));
+
+    double end = DEFAULT_RESET_TIME + NoximGlobalParams::simulation_time - 1;
+    cout << "Mapping only, for " << NoximGlobalParams::
+	simulation_time << " cycles..." << endl;
+    for (unsigned int i = 0; i < mappers.size(); i++)
+	mappers[i]->run(end);
+    cout << " ( " << end + 1 << " cycles executed)" << endl;
+
+    showMapping(mappers);
+
+    for (unsigned int i = 0; i < mappers.size(); i++)
+	delete mappers[i];
+}
+
 int sc_main(int arg_num, char *arg_vet[])
 {
     // TEMP
@@ -58,6 +259,23 @@ int sc_main(int arg_num, char *arg_vet[])
 
     parseCmdLine(arg_num, arg_vet);
 
+    // The applications can be replayed with -apptrace
+    if (NoximGlobalParams::app_dump_filename[0] != '\0') {
+	NoximAppTrace *trace = NoximAppTrace::create();
+	if (!trace->save(NoximGlobalParams::app_dump_filename)) {
+	    cerr << "Error: cannot write application trace " <<
+		NoximGlobalParams::app_dump_filename << endl;
+	    exit(1);
+	}
+	delete trace;
+    }
+
+    // No network at all: the mapping runs without SystemC
+    if (NoximGlobalParams::mapping_only) {
+	runMappingOnly();
+	return 0;
+    }
+
     // Signals
     sc_clock clock("clock", 1, SC_NS);
     sc_signal <bool> reset;
@@ -67,6 +285,14 @@ int sc_main(int arg_num, char *arg_vet[])
     n->clock(clock);
     n->reset(reset);
 
+    // The analytic model replaces the simulation
+    if (NoximGlobalParams::analytic_model) {
+	NoximAnalyticModel model(n);
+	model.evaluate();
+	model.showResults(std::cout);
+	return 0;
+    }
+
     // Trace signals
     sc_trace_file *tf = NULL;
     if (NoximGlobalParams::trace_mode) {
@@ -104,6 +330,15 @@ int sc_main(int arg_num, char *arg_vet[])
     srand(NoximGlobalParams::rnd_generator_seed);	// time(NULL));
     sc_start(DEFAULT_RESET_TIME, SC_NS);
     reset.write(0);
+
+    if (NoximGlobalParams::saturation_search_tolerance > 0.0) {
+	cout << " done! Now searching the saturation point..." << endl;
+	saturationSearch(n, std::cout);
+	if (NoximGlobalParams::trace_mode)
+	    sc_close_vcd_trace_file(tf);
+	return 0;
+    }
+
     cout << " done! Now running for " << NoximGlobalParams::
 	simulation_time << " cycles..." << endl;
     sc_start(NoximGlobalParams::simulation_time, SC_NS);
@@ -119,12 +354,8 @@ int sc_main(int arg_num, char *arg_vet[])
     NoximGlobalStats gs(n);
     gs.showStats(std::cout, NoximGlobalParams::detailed);
 
-    for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++) {
-	    for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
-	    	cout << n->t[i][j]->pe->budget <<"\t";
-	    }
-	    cout << endl;
-	}
+    // The mappers have been brought to the last cycle executed
+    showMapping(n->mappers);
 
     if ((NoximGlobalParams::max_volume_to_be_drained > 0) &&
 	(sc_time_stamp().to_double() / 1000 >=
@@ -45,8 +45,42 @@ using namespace std;
 #define SEL_RANDOM             0
 #define SEL_BUFFER_LEVEL       1
 #define SEL_NOP                2
+#define SEL_RCA                3
 #define INVALID_SELECTION     -1
 
+// Switch allocation policies
+#define SWITCH_ALLOC_ROUND_ROBIN  0
+#define SWITCH_ALLOC_ISLIP        1
+#define SWITCH_ALLOC_WAVEFRONT    2
+#define INVALID_SWITCH_ALLOC     -1
+
+// Actions taken when the watchdog finds a deadlock
+#define DEADLOCK_REPORT        0
+#define DEADLOCK_ABORT         1
+#define DEADLOCK_DRAIN         2
+#define INVALID_DEADLOCK_ACTION -1
+
+// Outcome of the steady-state convergence detection
+#define CONVERGENCE_RUNNING    0
+#define CONVERGENCE_REACHED    1
+#define CONVERGENCE_UNSTABLE   2
+
+// Batches collected before convergence is assessed
+#define CONVERGENCE_MIN_BATCHES 10
+
+// Saturation search: the zero-load latency is measured at this fraction
+// of the starting injection rate, and a probe whose delay exceeds the
+// zero-load one by this factor counts as saturated
+#define ZERO_LOAD_PIR_FRACTION  0.1
+#define SATURATION_DELAY_FACTOR 3.0
+
+// Topologies
+#define TOPOLOGY_MESH          0
+#define TOPOLOGY_TORUS         1
+#define TOPOLOGY_FOLDED_TORUS  2
+#define TOPOLOGY_GRAPH         3
+#define INVALID_TOPOLOGY      -1
+
 // Traffic distribution
 #define TRAFFIC_RANDOM         0
 #define TRAFFIC_TRANSPOSE1     1
@@ -56,8 +90,17 @@ using namespace std;
 #define TRAFFIC_BIT_REVERSAL   5
 #define TRAFFIC_SHUFFLE        6
 #define TRAFFIC_BUTTERFLY      7
+#define TRAFFIC_APPLICATION    8
 #define INVALID_TRAFFIC       -1
 
+// Mapping policies
+#define MAPPING_MOC            0
+#define MAPPING_RANDOM         1
+#define MAPPING_CONTIGUOUS     2
+#define MAPPING_FIRST_FIT      3
+#define MAPPING_COMM_AWARE     4
+#define INVALID_MAPPING       -1
+
 // Verbosity levels
 #define VERBOSE_OFF            0
 #define VERBOSE_LOW            1
@@ -76,6 +119,8 @@ using namespace std;
 #define DEFAULT_ROUTING_ALGORITHM                 ROUTING_XY
 #define DEFAULT_ROUTING_TABLE_FILENAME                    ""
 #define DEFAULT_SELECTION_STRATEGY                SEL_RANDOM
+#define DEFAULT_SWITCH_ALLOCATOR    SWITCH_ALLOC_ROUND_ROBIN
+#define DEFAULT_ISLIP_ITERATIONS                           1
 #define DEFAULT_PACKET_INJECTION_RATE                   0.01
 #define DEFAULT_PROBABILITY_OF_RETRANSMISSION           0.01
 #define DEFAULT_TRAFFIC_DISTRIBUTION          TRAFFIC_RANDOM
@@ -86,10 +131,70 @@ using namespace std;
 #define DEFAULT_DETAILED                               false
 #define DEFAULT_DYAD_THRESHOLD                           0.6
 #define DEFAULT_MAX_VOLUME_TO_BE_DRAINED                   0
+#define DEFAULT_CONVERGENCE_PRECISION                    0.0
+#define DEFAULT_CONVERGENCE_BATCH                       1000
+#define DEFAULT_SATURATION_SEARCH_TOLERANCE              0.0
+#define DEFAULT_ANALYTIC_MODEL                         false
 #define DEFAULT_ROUTER_PWR_FILENAME     "default_router.pwr"
 #define DEFAULT_LOW_POWER_LINK_STRATEGY                false
 #define DEFAULT_QOS                                      1.0
 #define DEFAULT_SHOW_BUFFER_STATS                      false
+#define DEFAULT_LINK_WIDTH                                 1
+#define DEFAULT_CROSSBAR_SPEEDUP                           1
+#define DEFAULT_RC_STAGES                                  0
+#define DEFAULT_SA_STAGES                                  1
+#define DEFAULT_ST_STAGES                                  0
+#define DEFAULT_LT_STAGES                                  0
+#define DEFAULT_LOOKAHEAD_ROUTING                      false
+#define DEFAULT_TOPOLOGY                       TOPOLOGY_MESH
+#define DEFAULT_TOPOLOGY_FILENAME                         ""
+#define DEFAULT_VIRTUAL_CHANNELS                           1
+#define DEFAULT_CONCENTRATION                              1
+#define DEFAULT_LINK_LATENCY                               1
+#define DEFAULT_LINK_PIPELINING                        false
+#define DEFAULT_CHIPS_X                                    1
+#define DEFAULT_CHIPS_Y                                    1
+#define DEFAULT_CHIP_LINKS                                 1
+#define DEFAULT_CHIP_LINK_LATENCY                          4
+#define DEFAULT_CHIP_LINK_PERIOD                           2
+#define DEFAULT_EXPRESS_SPAN                               0
+#define DEFAULT_EXPRESS_LATENCY                            1
+#define DEFAULT_SMART_HPC_MAX                              1
+#define DEFAULT_DEADLOCK_CHECK_PERIOD                      0
+#define DEFAULT_DEADLOCK_ACTION              DEADLOCK_REPORT
+#define DEFAULT_MAPPING_POLICY                   MAPPING_MOC
+#define DEFAULT_MAPPING_ONLY                           false
+#define DEFAULT_APP_TRACE_FILENAME                        ""
+#define DEFAULT_APP_DUMP_FILENAME                         ""
+#define DEFAULT_THERMAL_MODEL                          false
+
+// Weight of the local term when a router folds its own congestion
+// into the regional estimate received from downstream (RCA selection)
+#define RCA_LOCAL_WEIGHT 0.5
+
+// Maximum number of flits carried by a link in a single cycle
+#define MAX_LINK_WIDTH 8
+
+// Maximum number of virtual channels per link (the two dateline
+// classes used by the tori, one class per chip crossed in multi-chip
+// meshes)
+#define MAX_VIRTUAL_CHANNELS 4
+
+// Maximum number of PEs attached to a router, each one through its own
+// local port (DIRECTION_LOCAL, DIRECTION_LOCAL+1, ...)
+#define MAX_CONCENTRATION 4
+
+// Express links skip several routers of a mesh row or column: a router
+// has at most one in each direction, on the ports that follow the local
+// ones
+#define EXPRESS_DIRECTIONS 4
+
+// Network, local and express ports of a router
+#define MAX_ROUTER_PORTS (DIRECTIONS + MAX_CONCENTRATION + EXPRESS_DIRECTIONS)
+
+// Network ports of a router of a graph topology: the mesh ports and,
+// past them, the express ones
+#define MAX_GRAPH_PORTS (MAX_ROUTER_PORTS - MAX_CONCENTRATION)
 
 // TODO by Fafa - this MUST be removed!!! Use only STL vectors instead!!!
 #define MAX_STATIC_DIM 32
@@ -103,6 +208,29 @@ using namespace std;
 #define LN 2 // nominal faliure rate
 #define LC 3 // operating failure rate
 #define INTERVAL 200
+
+// Thermal model of the lifetime budgets (-thermal). An INTERVAL of the
+// lifetime model stands for THERMAL_TIME_STEP seconds of operation, in
+// which every tile dissipates the average power of its router and PEs.
+#define THERMAL_AMBIENT          318.15	// K
+#define THERMAL_CAPACITANCE      0.02	// J/K, of a tile
+#define THERMAL_R_VERTICAL       20.0	// K/W, from a tile to the ambient
+#define THERMAL_R_LATERAL        10.0	// K/W, between two tiles
+#define THERMAL_TIME_STEP        0.01	// s
+#define THERMAL_SOR_OMEGA        1.2
+#define THERMAL_TOLERANCE        1e-6	// K
+#define THERMAL_MAX_SWEEPS       100
+#define PE_ACTIVE_POWER          0.5	// W, of a PE running a task
+#define ACTIVATION_ENERGY        0.7	// eV, of the wear-out mechanism
+#define BOLTZMANN_CONSTANT       8.617e-5	// eV/K
+#define CYCLE_TIME               1e-9	// s, the clock of sc_main
+
+// Events driving the mapping layer. Events of the same cycle are
+// handled in this order: freed cores first, then new prices, then
+// new applications.
+#define MAPPING_EVENT_COMPLETION   0
+#define MAPPING_EVENT_PRICE_UPDATE 1
+#define MAPPING_EVENT_ARRIVAL      2
 struct PEPrice{
     int id;
     double price;
@@ -123,6 +251,8 @@ struct NoximGlobalParams {
     static int routing_algorithm;
     static char routing_table_filename[128];
     static int selection_strategy;
+    static int switch_allocator;
+    static int islip_iterations;
     static float packet_injection_rate;
     static float probability_of_retransmission;
     static int traffic_distribution;
@@ -134,10 +264,42 @@ struct NoximGlobalParams {
     static vector <pair <int, double> > hotspots;
     static float dyad_threshold;
     static unsigned int max_volume_to_be_drained;
+    static double convergence_precision;
+    static int convergence_batch;
+    static double saturation_search_tolerance;
+    static bool analytic_model;
     static char router_power_filename[128];
     static bool low_power_link_strategy;
     static double qos;
     static bool show_buffer_stats;
+    static int link_width;
+    static int crossbar_speedup;
+    static int rc_stages;
+    static int sa_stages;
+    static int st_stages;
+    static int lt_stages;
+    static bool lookahead_routing;
+    static int topology;
+    static char topology_filename[128];
+    static int virtual_channels;
+    static int concentration;
+    static int link_latency;
+    static bool link_pipelining;
+    static int chips_x;
+    static int chips_y;
+    static int chip_links;
+    static int chip_link_latency;
+    static int chip_link_period;
+    static int express_span;
+    static int express_latency;
+    static int smart_hpc_max;
+    static int deadlock_check_period;
+    static int deadlock_action;
+    static vector <int> mapping_policies;
+    static bool mapping_only;
+    static char app_trace_filename[128];
+    static char app_dump_filename[128];
+    static bool thermal_model;
 };
 
 
@@ -235,6 +397,7 @@ struct NoximFlit {
     double timestamp;		// Unix timestamp at packet generation
     int hop_no;			// Current number of hops from source to destination
     bool use_low_voltage_path;
+    int vc_id;			// Virtual channel the flit travels on
 
     inline bool operator ==(const NoximFlit & flit) const {
 	return (flit.src_id == src_id && flit.dst_id == dst_id
@@ -242,7 +405,70 @@ struct NoximFlit {
 		&& flit.sequence_no == sequence_no
 		&& flit.payload == payload && flit.timestamp == timestamp
 		&& flit.hop_no == hop_no
-		&& flit.use_low_voltage_path == use_low_voltage_path);
+		&& flit.use_low_voltage_path == use_low_voltage_path
+		&& flit.vc_id == vc_id);
+}};
+
+// NoximFlitBundle -- Flits moved through a link in a single handshake
+struct NoximFlitBundle {
+    int size;			// Number of valid flits (up to the link width)
+    NoximFlit flit[MAX_LINK_WIDTH];
+
+    NoximFlitBundle() {
+	size = 0;
+    }
+
+    inline bool operator ==(const NoximFlitBundle & bundle) const {
+	if (bundle.size != size)
+	    return false;
+	for (int i = 0; i < size; i++)
+	    if (!(bundle.flit[i] == flit[i]))
+		return false;
+	return true;
+}};
+
+// NoximCreditCount -- Flits drained so far from each virtual channel of
+// an input buffer. The upstream router compares it with the flits it
+// sent to know how many slots are still free.
+struct NoximCreditCount {
+    unsigned long drained[MAX_VIRTUAL_CHANNELS];
+
+    NoximCreditCount() {
+	for (int vc = 0; vc < MAX_VIRTUAL_CHANNELS; vc++)
+	    drained[vc] = 0;
+    }
+
+    inline bool operator ==(const NoximCreditCount & credits) const {
+	for (int vc = 0; vc < MAX_VIRTUAL_CHANNELS; vc++)
+	    if (credits.drained[vc] != drained[vc])
+		return false;
+	return true;
+}};
+
+// NoximSmartLink -- SMART side network of a mesh link. Setup requests
+// and the flits going through the bypass travel with the link; the room
+// left where they land and the routers bypassed to get there travel back
+// to the requester, on the link of the opposite direction.
+struct NoximSmartLink {
+    int request_dst;		// Destination router of the setup request, NOT_VALID if none
+    int request_hops;		// Routers the request may still go through
+    NoximFlitBundle flits;	// Flits going through the bypass
+    int landing_room;		// Free slots of the input buffer they land in
+    int landing_hops;		// Routers bypassed before landing
+
+    NoximSmartLink() {
+	request_dst = NOT_VALID;
+	request_hops = 0;
+	landing_room = 0;
+	landing_hops = 0;
+    }
+
+    inline bool operator ==(const NoximSmartLink & link) const {
+	return (link.request_dst == request_dst
+		&& link.request_hops == request_hops
+		&& link.flits == flits
+		&& link.landing_room == landing_room
+		&& link.landing_hops == landing_hops);
 }};
 
 // Output overloading
@@ -272,6 +498,7 @@ inline ostream & operator <<(ostream & os, const NoximFlit & flit)
 	    timestamp << endl;
 	os << "Total number of hops from source to destination is " <<
 	    flit.hop_no << endl;
+	os << "Virtual channel " << flit.vc_id << endl;
     } else {
 	os << "[type: ";
 	switch (flit.flit_type) {
@@ -292,6 +519,36 @@ inline ostream & operator <<(ostream & os, const NoximFlit & flit)
     return os;
 }
 
+inline ostream & operator <<(ostream & os, const NoximFlitBundle & bundle)
+{
+    os << "{";
+    for (int i = 0; i < bundle.size; i++)
+	os << " " << bundle.flit[i];
+    os << " }";
+
+    return os;
+}
+
+inline ostream & operator <<(ostream & os,
+			     const NoximCreditCount & credits)
+{
+    os << "[";
+    for (int vc = 0; vc < MAX_VIRTUAL_CHANNELS; vc++)
+	os << " " << credits.drained[vc];
+    os << " ]";
+
+    return os;
+}
+
+inline ostream & operator <<(ostream & os, const NoximSmartLink & link)
+{
+    os << "request(" << link.request_dst << "," << link.request_hops <<
+	") " << link.flits << " landing(" << link.landing_room << "," <<
+	link.landing_hops << ")";
+
+    return os;
+}
+
 inline ostream & operator <<(ostream & os,
 			     const NoximChannelStatus & status)
 {
@@ -333,6 +590,25 @@ inline void sc_trace(sc_trace_file * &tf, const NoximFlit & flit, string & name)
     sc_trace(tf, flit.hop_no, name + ".hop_no");
 }
 
+inline void sc_trace(sc_trace_file * &tf, const NoximFlitBundle & bundle, string & name)
+{
+    string first = name + ".flit0";
+
+    sc_trace(tf, bundle.size, name + ".size");
+    sc_trace(tf, bundle.flit[0], first);
+}
+
+inline void sc_trace(sc_trace_file * &tf, const NoximCreditCount & credits, string & name)
+{
+    sc_trace(tf, credits.drained[0], name + ".drained0");
+}
+
+inline void sc_trace(sc_trace_file * &tf, const NoximSmartLink & link, string & name)
+{
+    sc_trace(tf, link.request_dst, name + ".request_dst");
+    sc_trace(tf, link.landing_room, name + ".landing_room");
+}
+
 inline void sc_trace(sc_trace_file * &tf, const NoximNoP_data & NoP_data, string & name)
 {
     sc_trace(tf, NoP_data.sender_id, name + ".sender_id");
@@ -368,4 +644,106 @@ inline int coord2Id(const NoximCoord & coord)
     return id;
 }
 
+// PEs attached to the same router have consecutive ids
+
+inline int peRouterId(const int pe_id)
+{
+    return pe_id / NoximGlobalParams::concentration;
+}
+
+inline int peIndex(const int pe_id)
+{
+    return pe_id % NoximGlobalParams::concentration;
+}
+
+inline int peCount()
+{
+    return NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y *
+	NoximGlobalParams::concentration;
+}
+
+// Mesh hops between the routers of two PEs
+inline int peDistance(const int pe_a, const int pe_b)
+{
+    NoximCoord a = id2Coord(peRouterId(pe_a));
+    NoximCoord b = id2Coord(peRouterId(pe_b));
+
+    return abs(a.x - b.x) + abs(a.y - b.y);
+}
+
+// A multi-chip mesh is split into chips_x x chips_y chips of the same
+// size, numbered row by row
+
+inline int chipWidth()
+{
+    return NoximGlobalParams::mesh_dim_x / NoximGlobalParams::chips_x;
+}
+
+inline int chipHeight()
+{
+    return NoximGlobalParams::mesh_dim_y / NoximGlobalParams::chips_y;
+}
+
+inline int chipId(const int router_id)
+{
+    NoximCoord coord = id2Coord(router_id);
+
+    return (coord.y / chipHeight()) * NoximGlobalParams::chips_x +
+	coord.x / chipWidth();
+}
+
+// Router at the other end of the express link leaving router_id
+// towards direction, NOT_VALID if there is none. Express links of
+// span k connect the routers whose coordinate is a multiple of k.
+inline int expressNeighbor(const int router_id, const int direction)
+{
+    int k = NoximGlobalParams::express_span;
+    NoximCoord coord = id2Coord(router_id);
+
+    if (k == 0)
+	return NOT_VALID;
+
+    if (direction == DIRECTION_EAST || direction == DIRECTION_WEST) {
+	if (coord.x % k != 0)
+	    return NOT_VALID;
+	coord.x += (direction == DIRECTION_EAST) ? k : -k;
+    } else {
+	if (coord.y % k != 0)
+	    return NOT_VALID;
+	coord.y += (direction == DIRECTION_SOUTH) ? k : -k;
+    }
+
+    if (coord.x < 0 || coord.x >= NoximGlobalParams::mesh_dim_x ||
+	coord.y < 0 || coord.y >= NoximGlobalParams::mesh_dim_y)
+	return NOT_VALID;
+
+    return coord2Id(coord);
+}
+
+// Router port of port p of a graph topology and the other way round,
+// for a network port: the ports past the mesh ones are the express
+// ports, which follow the local ones
+inline int graphRouterPort(const int p)
+{
+    if (p < DIRECTIONS)
+	return p;
+
+    return p + NoximGlobalParams::concentration;
+}
+
+inline int graphPort(const int router_port)
+{
+    if (router_port < DIRECTIONS)
+	return router_port;
+
+    return router_port - NoximGlobalParams::concentration;
+}
+
+// Offset of the n-th inter-chip link along a chip edge of k routers:
+// the links are spread evenly over the edge
+inline int chipLinkOffset(const int n, const int k)
+{
+    return (2 * n + 1) * k / (2 * NoximGlobalParams::chip_links);
+}
+
 #endif
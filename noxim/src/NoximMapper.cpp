@@ -0,0 +1,244 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the mapping layer
+ */
+
+#include "NoximMapper.h"
+
+NoximMapper::NoximMapper(NoximAppTrace * _trace,
+			 NoximMappingPolicy * _policy)
+{
+    trace = _trace;
+    policy = _policy;
+    lifetime.configure(peCount());
+    lifetime.setListener(this);
+    thermal.configure(NoximGlobalParams::mesh_dim_x,
+		      NoximGlobalParams::mesh_dim_y);
+    reset(DEFAULT_RESET_TIME);
+}
+
+NoximMapper::~NoximMapper()
+{
+    delete policy;
+    delete trace;
+}
+
+const char *NoximMapper::getPolicyName() const
+{
+    return policy->getName();
+}
+
+void NoximMapper::scheduleMappingEvent(const double time, const int type,
+				       const int app)
+{
+    NoximMappingEvent e;
+    e.time = time;
+    e.type = type;
+    e.app = app;
+    mapping_events.push(e);
+}
+
+void NoximMapper::reset(const double start)
+{
+    lifetime.reset(start);
+    thermal.reset();
+    router_energy.assign(NoximGlobalParams::mesh_dim_x *
+			 NoximGlobalParams::mesh_dim_y, 0.0);
+
+    app_queue.clear();
+    waiting_queue.clear();
+    running_app.clear();
+
+    while (!mapping_events.empty())
+	mapping_events.pop();
+    trace->rewind();
+    scheduleNextArrival();
+
+    // the PEs update their budgets in the cycle before
+    int first_update = ((int) start + INTERVAL - 1) / INTERVAL * INTERVAL;
+    scheduleMappingEvent(first_update, MAPPING_EVENT_PRICE_UPDATE,
+			 NOT_VALID);
+
+    start_time = start;
+    busy_cycles = 0.0;
+    started = 0;
+    completed = 0;
+    waiting_cycles = 0.0;
+}
+
+void NoximMapper::advanceTo(const double now)
+{
+    // nothing has been mapped or freed since the last call
+    busy_cycles += lifetime.getBusyCores() * (now - lifetime.getTime());
+    if (NoximGlobalParams::thermal_model)
+	while (lifetime.getNextRefill() <= now) {
+	    lifetime.advanceTo(lifetime.getNextRefill());
+	    updateTemperatures();
+	}
+    lifetime.advanceTo(now);
+
+    bool changed = false;
+    while (!mapping_events.empty() && mapping_events.top().time <= now) {
+	NoximMappingEvent e = mapping_events.top();
+	mapping_events.pop();
+	changed = true;
+
+	switch (e.type) {
+	case MAPPING_EVENT_COMPLETION:
+	    completeApplication(e.app);
+	    break;
+	case MAPPING_EVENT_PRICE_UPDATE:
+	    // the PEs have been refilled in the cycle before
+	    scheduleMappingEvent(e.time + INTERVAL,
+				 MAPPING_EVENT_PRICE_UPDATE, NOT_VALID);
+	    break;
+	case MAPPING_EVENT_ARRIVAL:
+	    waiting_queue.push_back(e.app);
+	    scheduleNextArrival();
+	    break;
+	}
+    }
+
+    if (changed) {
+	policy->arrival(*this);
+	policy->rebalance(*this);
+    }
+}
+
+void NoximMapper::scheduleNextArrival()
+{
+    APPLICATION a;
+    if (!trace->next(a))
+	return;
+
+    app_queue[a.app_id] = a;
+    scheduleMappingEvent(a.arrival, MAPPING_EVENT_ARRIVAL, a.app_id);
+}
+
+void NoximMapper::addRouterEnergy(const int router, const double energy)
+{
+    router_energy[router] += energy;
+}
+
+void NoximMapper::updateTemperatures()
+{
+    // average power over the interval just ended
+    vector <double> power(router_energy.size(), 0.0);
+    for (int id = 0; id < peCount(); id++)
+	power[peRouterId(id)] +=
+	    PE_ACTIVE_POWER * lifetime.getActiveCycles(id) / INTERVAL;
+    for (unsigned int r = 0; r < router_energy.size(); r++) {
+	power[r] += router_energy[r] / (INTERVAL * CYCLE_TIME);
+	router_energy[r] = 0.0;
+    }
+    lifetime.clearActiveCycles();
+
+    thermal.step(power);
+    for (int id = 0; id < peCount(); id++)
+	lifetime.setWear(id, thermal.getWearFactor(peRouterId(id)));
+}
+
+void NoximMapper::run(const double end)
+{
+    // in the cycles between two events only the budgets change, and
+    // advanceTo() charges and refills them in closed form. The price
+    // updates keep the heap from ever getting empty.
+    while (mapping_events.top().time <= end)
+	advanceTo(mapping_events.top().time);
+    advanceTo(end);
+}
+
+void NoximMapper::startApplication(const int app, const int id)
+{
+    int time = (int) lifetime.getTime();
+    APPLICATION & a = app_queue[app];
+
+    a.ini_mapping(id, time, lifetime);
+    lifetime.mapTask(id, app, time + (int) a.lifetime);
+    a.money_used += lifetime.getPrice(id);
+    running_app.push_back(app);
+
+    // the PEs free themselves once past their end time
+    scheduleMappingEvent(time + a.lifetime + 1, MAPPING_EVENT_COMPLETION,
+			 app);
+
+    started++;
+    waiting_cycles += time - a.arrival;
+}
+
+void NoximMapper::completeApplication(const int app)
+{
+    APPLICATION & a = app_queue[app];
+    for (deque <int>::iterator it = a.cores.begin(); it != a.cores.end();
+	 it++)
+	lifetime.clearTask(*it);
+    a.clear_cores();
+    a.money_used = 0;
+
+    running_app.erase(find(running_app.begin(), running_app.end(), app));
+    completed++;
+
+    policy->release(*this, app);
+    app_queue.erase(app);
+}
+
+void NoximMapper::occupancyChanged(const int id)
+{
+    // the applications with a core next to id
+    const vector <int> & adjacent = adjacent_cores(id);
+    for (vector <int>::const_iterator m = adjacent.begin();
+	 m != adjacent.end(); m++) {
+	if (!lifetime.isOccupied(*m))
+	    continue;
+	map <int, APPLICATION>::iterator it =
+	    app_queue.find(lifetime.getApp(*m));
+	if (it != app_queue.end())
+	    it->second.reindex(id, lifetime);
+    }
+}
+
+void NoximMapper::pricesChanged()
+{
+    for (vector <int>::iterator it = running_app.begin();
+	 it != running_app.end(); it++)
+	app_queue[*it].reprice(lifetime);
+}
+
+void NoximMapper::showStats(std::ostream & out) const
+{
+    // up to the end of the current cycle
+    double cycles = lifetime.getTime() + 1 - start_time;
+    double busy = busy_cycles + lifetime.getBusyCores();
+
+    double min_budget = 0.0;
+    double total_budget = 0.0;
+    int disabled = 0;
+    for (int id = 0; id < peCount(); id++) {
+	double b = lifetime.getBudget(id);
+	if (id == 0 || b < min_budget)
+	    min_budget = b;
+	total_budget += b;
+	if (b < 0)
+	    disabled++;
+    }
+
+    out << "Mapping policy " << getPolicyName() << ":" << endl;
+    out << "  Applications started: " << started << ", completed: " <<
+	completed << ", waiting: " << waiting_queue.size() << endl;
+    out << "  Average waiting time (cycles): " <<
+	(started > 0 ? waiting_cycles / started : 0.0) << endl;
+    out << "  PE utilization: " <<
+	(cycles > 0 ? busy / (peCount() * cycles) : 0.0) << endl;
+    out << "  Average lifetime budget: " << total_budget / peCount() <<
+	", minimum: " << min_budget << ", PEs over budget: " << disabled <<
+	endl;
+    if (NoximGlobalParams::thermal_model)
+	out << "  Temperature (K): average " << thermal.
+	    getAverageTemperature() << ", peak " << thermal.
+	    getPeakTemperature() << endl;
+}
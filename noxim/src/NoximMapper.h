@@ -0,0 +1,105 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the mapping layer
+ */
+
+#ifndef __NOXIMMAPPER_H__
+#define __NOXIMMAPPER_H__
+
+#include <iostream>
+#include <map>
+#include <deque>
+#include <queue>
+#include <vector>
+#include <functional>
+#include "NoximMain.h"
+#include "NoximApp.h"
+#include "NoximAppTrace.h"
+#include "NoximLifetime.h"
+#include "NoximThermal.h"
+#include "NoximMappingPolicy.h"
+using namespace std;
+
+// Maps a trace of applications onto the PEs with a policy. The mapping
+// only changes when an application arrives or ends and when the prices
+// are updated: the events are kept in a min-heap and the cycles in
+// between cost nothing. The trace is read one application ahead, and
+// only the applications that have arrived and not ended yet are kept.
+class NoximMapper : public NoximLifetimeListener {
+  public:
+
+    // The mapper owns the trace and the policy
+    NoximMapper(NoximAppTrace * _trace, NoximMappingPolicy * _policy);
+    ~NoximMapper();
+
+    // Starts over at cycle start, with every PE free
+    void reset(const double start);
+
+    // Handles the events due up to cycle now, included
+    void advanceTo(const double now);
+
+    // Jumps from an event to the next one up to cycle end, included,
+    // without a clock
+    void run(const double end);
+
+    // Applications, keyed by app_id, and their state
+    map <int, APPLICATION> app_queue;
+    deque <int> waiting_queue;	// Arrived and not started yet
+    vector <int> running_app;
+
+    // Lifetime budget and task of the PEs
+    NoximLifetime lifetime;
+
+    // Temperatures of the tiles, with -thermal. They are updated at
+    // every refill, and set the wear of the PEs until the next one.
+    NoximThermal thermal;
+
+    // Energy dissipated by router in J, added to its tile at the next
+    // thermal update
+    void addRouterEnergy(const int router, const double energy);
+
+    // Application app starts on PE id in the current cycle
+    void startApplication(const int app, const int id);
+
+    // The applications next to a PE that gets busy or free, and every
+    // running one when the prices change, update their price-ordered
+    // neighbors and margins
+    void occupancyChanged(const int id);
+    void pricesChanged();
+
+    const char *getPolicyName() const;
+
+    void showStats(std::ostream & out) const;
+
+  private:
+
+    NoximAppTrace *trace;
+    NoximMappingPolicy *policy;
+
+    priority_queue <NoximMappingEvent, vector <NoximMappingEvent>,
+		    greater <NoximMappingEvent> > mapping_events;
+    void scheduleMappingEvent(const double time, const int type,
+			      const int app);
+    void completeApplication(const int app);
+
+    // Reads the next application of the trace, if any, into app_queue
+    // and schedules its arrival
+    void scheduleNextArrival();
+
+    vector <double> router_energy;	// Since the last thermal update
+    void updateTemperatures();
+
+    // Statistics
+    double start_time;
+    double busy_cycles;		// Cycles run by every PE, summed
+    int started;
+    int completed;
+    double waiting_cycles;	// Of the applications started
+};
+
+#endif
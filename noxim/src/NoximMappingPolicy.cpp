@@ -0,0 +1,261 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the mapping policies
+ */
+
+#include <cstdlib>
+#include "NoximMappingPolicy.h"
+#include "NoximMapper.h"
+
+NoximMappingPolicy *NoximMappingPolicy::create(const int policy)
+{
+    switch (policy) {
+    case MAPPING_MOC:
+	return new NoximMoCMapping();
+    case MAPPING_RANDOM:
+	return new NoximRandomMapping();
+    case MAPPING_CONTIGUOUS:
+	return new NoximContiguousMapping();
+    case MAPPING_FIRST_FIT:
+	return new NoximFirstFitMapping();
+    case MAPPING_COMM_AWARE:
+	return new NoximCommAwareMapping();
+    default:
+	return NULL;
+    }
+}
+
+const char *NoximMoCMapping::getName() const
+{
+    return "moc";
+}
+
+void NoximMoCMapping::arrival(NoximMapper & mapper)
+{
+    // the waiting applications start on the cheapest free cores, in
+    // order of arrival
+    while (!mapper.waiting_queue.empty() &&
+	   !mapper.lifetime.freeCores().empty()) {
+	int app = mapper.waiting_queue.front();
+	mapper.waiting_queue.pop_front();
+	mapper.startApplication(app, mapper.lifetime.freeCores().cheapest());
+    }
+}
+
+void NoximMoCMapping::updateMoney(NoximMapper & mapper)
+{
+    for (unsigned int i = 0; i < mapper.running_app.size(); i++)
+	mapper.app_queue[mapper.running_app[i]].money_allowed =
+	    1.0 / mapper.running_app.size();
+}
+
+void NoximMoCMapping::rebalance(NoximMapper & mapper)
+{
+    updateMoney(mapper);
+
+    // an expansion brings new cores next to the application: repeat
+    // until the mapping settles, which would otherwise take a cycle
+    // per ring of cores
+    int moved;
+    int rounds = 0;
+    do {
+	moved = 0;
+	for (unsigned int r = 0; r < mapper.running_app.size(); r++) {
+	    APPLICATION & a = mapper.app_queue[mapper.running_app[r]];
+	    if (a.money_used < a.money_allowed)
+		moved += a.expand(mapper.lifetime);
+	    else
+		moved += a.shrink(mapper.lifetime);
+	}
+    } while (moved > 0 && ++rounds < peCount());
+}
+
+void NoximStaticMapping::arrival(NoximMapper & mapper)
+{
+    vector <int> free;
+    for (int id = 0; id < peCount(); id++)
+	if (!mapper.lifetime.isOccupied(id))
+	    free.push_back(id);
+
+    while (!mapper.waiting_queue.empty() && !free.empty()) {
+	int app = mapper.waiting_queue.front();
+	APPLICATION & a = mapper.app_queue[app];
+	mapper.waiting_queue.pop_front();
+
+	int wanted = a.useful_cores();
+	int id = pickCore(mapper, app, free);
+	mapper.startApplication(app, id);
+	free.erase(find(free.begin(), free.end(), id));
+
+	while ((int) a.cores.size() < wanted && !free.empty()) {
+	    id = pickCore(mapper, app, free);
+	    if (id == NOT_VALID)
+		break;
+	    a.invade(id, mapper.lifetime);
+	    free.erase(find(free.begin(), free.end(), id));
+	}
+    }
+}
+
+NoximRandomMapping::NoximRandomMapping()
+{
+    seed = NoximGlobalParams::rnd_generator_seed;
+}
+
+const char *NoximRandomMapping::getName() const
+{
+    return "random";
+}
+
+int NoximRandomMapping::pickCore(NoximMapper & mapper, const int app,
+				 const vector <int> & free)
+{
+    return free[rand_r(&seed) % free.size()];
+}
+
+const char *NoximContiguousMapping::getName() const
+{
+    return "contiguous";
+}
+
+int NoximContiguousMapping::pickCore(NoximMapper & mapper, const int app,
+				     const vector <int> & free)
+{
+    const APPLICATION & a = mapper.app_queue[app];
+    if (a.cores.empty())
+	return free[0];
+
+    // the neighbors are ordered by id
+    for (set <int>::const_iterator it = a.neighbors.begin();
+	 it != a.neighbors.end(); it++)
+	if (!mapper.lifetime.isOccupied(*it))
+	    return *it;
+
+    return NOT_VALID;
+}
+
+const char *NoximFirstFitMapping::getName() const
+{
+    return "firstfit";
+}
+
+int NoximFirstFitMapping::pickCore(NoximMapper & mapper, const int app,
+				   const vector <int> & free)
+{
+    return free[0];
+}
+
+NoximCommAwareMapping::NoximCommAwareMapping()
+{
+    current_app = NOT_VALID;
+    n_cores = 0;
+}
+
+const char *NoximCommAwareMapping::getName() const
+{
+    return "commaware";
+}
+
+void NoximCommAwareMapping::buildLinks(const APPLICATION & a, const int n)
+{
+    n_cores = n;
+    links.assign(n, map <int, double> ());
+
+    for (unsigned int i = 0; i < a.graph.size(); i++) {
+	int s = a.graph[i].src % n;
+	int d = a.graph[i].dst % n;
+	if (s != d) {
+	    links[s][d] += a.graph[i].volume;
+	    links[d][s] += a.graph[i].volume;
+	}
+    }
+}
+
+int NoximCommAwareMapping::reachableCores(NoximMapper & mapper,
+					   const int start,
+					   const int limit) const
+{
+    vector <bool> seen(peCount(), false);
+    deque <int> front;
+    int count = 0;
+
+    seen[start] = true;
+    front.push_back(start);
+    while (!front.empty() && count < limit) {
+	int n = front.front();
+	front.pop_front();
+	count++;
+
+	const vector <int> & adjacent = adjacent_cores(n);
+	for (unsigned int i = 0; i < adjacent.size(); i++) {
+	    int m = adjacent[i];
+	    if (!seen[m] && !mapper.lifetime.isOccupied(m)) {
+		seen[m] = true;
+		front.push_back(m);
+	    }
+	}
+    }
+
+    return count;
+}
+
+double NoximCommAwareMapping::addedCost(const APPLICATION & a, const int k,
+					const int id) const
+{
+    double cost = 0.0;
+
+    // only the edges of core k change the cost: the ones among the
+    // cores already placed stay as they are
+    if (a.graph.empty()) {
+	for (int j = 0; j < k; j++)
+	    cost += peDistance(id, a.cores[j]);
+    } else {
+	for (map <int, double>::const_iterator it = links[k].begin();
+	     it != links[k].end() && it->first < k; it++)
+	    cost += it->second * peDistance(id, a.cores[it->first]);
+    }
+
+    return cost;
+}
+
+int NoximCommAwareMapping::pickCore(NoximMapper & mapper, const int app,
+				    const vector <int> & free)
+{
+    const APPLICATION & a = mapper.app_queue[app];
+    if (a.cores.empty()) {
+	// the cores the application will get, which the tasks are dealt
+	// over: as many as it can use among the free PEs connected to
+	// the first one, so that the region always grows to all of them
+	current_app = app;
+	buildLinks(a, reachableCores(mapper, free[0], a.useful_cores()));
+	return free[0];
+    }
+
+    int k = a.cores.size();
+    if (app != current_app || k >= n_cores)
+	return NOT_VALID;
+
+    // the cheapest PE breaks the ties
+    int best = NOT_VALID;
+    double best_cost = 0.0;
+    for (set <int>::const_iterator it = a.neighbors.begin();
+	 it != a.neighbors.end(); it++) {
+	if (mapper.lifetime.isOccupied(*it))
+	    continue;
+
+	double cost = addedCost(a, k, *it);
+	if (best == NOT_VALID || cost < best_cost ||
+	    (cost == best_cost &&
+	     mapper.lifetime.getPrice(*it) < mapper.lifetime.getPrice(best))) {
+	    best = *it;
+	    best_cost = cost;
+	}
+    }
+
+    return best;
+}
@@ -0,0 +1,134 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the mapping policies
+ */
+
+#ifndef __NOXIMMAPPINGPOLICY_H__
+#define __NOXIMMAPPINGPOLICY_H__
+
+#include <map>
+#include <vector>
+#include "NoximMain.h"
+#include "NoximApp.h"
+using namespace std;
+
+class NoximMapper;
+
+// A mapping policy decides which PEs run the applications. The mapper
+// calls it whenever the applications or the prices change.
+class NoximMappingPolicy {
+  public:
+
+    virtual ~NoximMappingPolicy() {}
+
+    virtual const char *getName() const = 0;
+
+    // Starts the waiting applications, in order of arrival, as long as
+    // there are PEs for them
+    virtual void arrival(NoximMapper & mapper) = 0;
+
+    // Moves PEs among the running applications
+    virtual void rebalance(NoximMapper & mapper) {}
+
+    // The PEs of application app have just been freed
+    virtual void release(NoximMapper & mapper, const int app) {}
+
+    // The policy identified by MAPPING_*, NULL if there is none
+    static NoximMappingPolicy *create(const int policy);
+};
+
+// The market of the paper: an application starts on the cheapest PE
+// and then hires and fires the PEs next to it within its money
+class NoximMoCMapping : public NoximMappingPolicy {
+  public:
+    const char *getName() const;
+    void arrival(NoximMapper & mapper);
+    void rebalance(NoximMapper & mapper);
+
+  private:
+    // Every running application gets the same share of money
+    void updateMoney(NoximMapper & mapper);
+};
+
+// The policies below give an application the PEs it can use at once,
+// as many as are free, and never move them afterwards
+class NoximStaticMapping : public NoximMappingPolicy {
+  public:
+    void arrival(NoximMapper & mapper);
+
+  protected:
+    // Next PE for application app among the free ones, NOT_VALID if
+    // the policy does not want any of them
+    virtual int pickCore(NoximMapper & mapper, const int app,
+			 const vector <int> & free) = 0;
+};
+
+// Free PEs drawn at random
+class NoximRandomMapping : public NoximStaticMapping {
+  public:
+    NoximRandomMapping();
+    const char *getName() const;
+
+  protected:
+    int pickCore(NoximMapper & mapper, const int app,
+		 const vector <int> & free);
+
+  private:
+    unsigned int seed;		// Not shared with the traffic generators
+};
+
+// A region grown from the first free PE, one neighbor at a time
+class NoximContiguousMapping : public NoximStaticMapping {
+  public:
+    const char *getName() const;
+
+  protected:
+    int pickCore(NoximMapper & mapper, const int app,
+		 const vector <int> & free);
+};
+
+// The free PEs with the lowest ids
+class NoximFirstFitMapping : public NoximStaticMapping {
+  public:
+    const char *getName() const;
+
+  protected:
+    int pickCore(NoximMapper & mapper, const int app,
+		 const vector <int> & free);
+};
+
+// A contiguous region too, grown each time towards the neighbor that
+// adds the least communication distance, counted on the communication
+// graph of the application (all-to-all if it has none)
+class NoximCommAwareMapping : public NoximStaticMapping {
+  public:
+    NoximCommAwareMapping();
+    const char *getName() const;
+
+  protected:
+    int pickCore(NoximMapper & mapper, const int app,
+		 const vector <int> & free);
+
+  private:
+    // The tasks are dealt over the cores in order: with n cores, the
+    // k-th one runs the tasks t with t % n == k. links[k] holds the
+    // volume exchanged by core k with each other core.
+    int current_app;
+    int n_cores;
+    vector < map <int, double> > links;
+    void buildLinks(const APPLICATION & a, const int n);
+
+    // Free PEs a region grown from PE start can reach, up to limit
+    int reachableCores(NoximMapper & mapper, const int start,
+		       const int limit) const;
+
+    // Volume times hops to the cores placed so far, for core k on PE id
+    double addedCost(const APPLICATION & a, const int k, const int id) const;
+};
+
+#endif
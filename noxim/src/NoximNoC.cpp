@@ -8,6 +8,7 @@
  * This file contains the implementation of the Network-on-Chip
  */
 
+#include <cmath>
 #include "NoximNoC.h"
 
 void NoximNoC::buildMesh()
@@ -20,44 +21,48 @@ void NoximNoC::buildMesh()
     if (NoximGlobalParams::traffic_distribution == TRAFFIC_TABLE_BASED)
 	assert(gttable.load(NoximGlobalParams::traffic_table_filename));
 	
-	// Generate application queue
-	generate_arrivals ();
+	// Every mapper reads the application trace on its own
+	for (unsigned int i = 0; i < NoximGlobalParams::mapping_policies.size(); i++)
+		mappers.push_back(new NoximMapper(NoximAppTrace::create(),
+			NoximMappingPolicy::create(NoximGlobalParams::mapping_policies[i])));
+
+    // Routers connected as described by a file
+    if (NoximGlobalParams::topology == TOPOLOGY_GRAPH) {
+	if (!gtopology.load(NoximGlobalParams::topology_filename)) {
+	    cerr << "Error: cannot load topology file " <<
+		NoximGlobalParams::topology_filename << endl;
+	    exit(1);
+	}
+	buildGraph();
+	return;
+    }
 
     // Create the mesh as a matrix of tiles
     for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++) {
 	for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
-	    // Create the single Tile with a proper name
-	    char tile_name[20];
-	    sprintf(tile_name, "Tile[%02d][%02d]", i, j);
-	    t[i][j] = new NoximTile(tile_name);
-
-	    // Tell to the router its coordinates
-	    t[i][j]->r->configure(j * NoximGlobalParams::mesh_dim_x + i,
-				  NoximGlobalParams::stats_warm_up_time,
-				  NoximGlobalParams::buffer_depth,
-				  grtable);
-
-	    // Tell to the PE its coordinates
-	    t[i][j]->pe->local_id = j * NoximGlobalParams::mesh_dim_x + i;
-	    t[i][j]->pe->traffic_table = &gttable;	// Needed to choose destination
-	    t[i][j]->pe->never_transmit = (gttable.occurrencesAsSource(t[i][j]->pe->local_id) == 0);
-
-	    // Map clock and reset
-	    t[i][j]->clock(clock);
-	    t[i][j]->reset(reset);
+	    createTile(i, j);
+
+	    // Index of the signals shared with the east and south
+	    // neighbors: tori wrap them around to the first column/row
+	    int ei = i + 1;
+	    int sj = j + 1;
+	    if (NoximGlobalParams::topology != TOPOLOGY_MESH) {
+		ei %= NoximGlobalParams::mesh_dim_x;
+		sj %= NoximGlobalParams::mesh_dim_y;
+	    }
 
 	    // Map Rx signals
 	    t[i][j]->req_rx[DIRECTION_NORTH] (req_to_south[i][j]);
 	    t[i][j]->flit_rx[DIRECTION_NORTH] (flit_to_south[i][j]);
 	    t[i][j]->ack_rx[DIRECTION_NORTH] (ack_to_north[i][j]);
 
-	    t[i][j]->req_rx[DIRECTION_EAST] (req_to_west[i + 1][j]);
-	    t[i][j]->flit_rx[DIRECTION_EAST] (flit_to_west[i + 1][j]);
-	    t[i][j]->ack_rx[DIRECTION_EAST] (ack_to_east[i + 1][j]);
+	    t[i][j]->req_rx[DIRECTION_EAST] (req_to_west[ei][j]);
+	    t[i][j]->flit_rx[DIRECTION_EAST] (flit_to_west[ei][j]);
+	    t[i][j]->ack_rx[DIRECTION_EAST] (ack_to_east[ei][j]);
 
-	    t[i][j]->req_rx[DIRECTION_SOUTH] (req_to_north[i][j + 1]);
-	    t[i][j]->flit_rx[DIRECTION_SOUTH] (flit_to_north[i][j + 1]);
-	    t[i][j]->ack_rx[DIRECTION_SOUTH] (ack_to_south[i][j + 1]);
+	    t[i][j]->req_rx[DIRECTION_SOUTH] (req_to_north[i][sj]);
+	    t[i][j]->flit_rx[DIRECTION_SOUTH] (flit_to_north[i][sj]);
+	    t[i][j]->ack_rx[DIRECTION_SOUTH] (ack_to_south[i][sj]);
 
 	    t[i][j]->req_rx[DIRECTION_WEST] (req_to_east[i][j]);
 	    t[i][j]->flit_rx[DIRECTION_WEST] (flit_to_east[i][j]);
@@ -68,13 +73,13 @@ void NoximNoC::buildMesh()
 	    t[i][j]->flit_tx[DIRECTION_NORTH] (flit_to_north[i][j]);
 	    t[i][j]->ack_tx[DIRECTION_NORTH] (ack_to_south[i][j]);
 
-	    t[i][j]->req_tx[DIRECTION_EAST] (req_to_east[i + 1][j]);
-	    t[i][j]->flit_tx[DIRECTION_EAST] (flit_to_east[i + 1][j]);
-	    t[i][j]->ack_tx[DIRECTION_EAST] (ack_to_west[i + 1][j]);
+	    t[i][j]->req_tx[DIRECTION_EAST] (req_to_east[ei][j]);
+	    t[i][j]->flit_tx[DIRECTION_EAST] (flit_to_east[ei][j]);
+	    t[i][j]->ack_tx[DIRECTION_EAST] (ack_to_west[ei][j]);
 
-	    t[i][j]->req_tx[DIRECTION_SOUTH] (req_to_south[i][j + 1]);
-	    t[i][j]->flit_tx[DIRECTION_SOUTH] (flit_to_south[i][j + 1]);
-	    t[i][j]->ack_tx[DIRECTION_SOUTH] (ack_to_north[i][j + 1]);
+	    t[i][j]->req_tx[DIRECTION_SOUTH] (req_to_south[i][sj]);
+	    t[i][j]->flit_tx[DIRECTION_SOUTH] (flit_to_south[i][sj]);
+	    t[i][j]->ack_tx[DIRECTION_SOUTH] (ack_to_north[i][sj]);
 
 	    t[i][j]->req_tx[DIRECTION_WEST] (req_to_west[i][j]);
 	    t[i][j]->flit_tx[DIRECTION_WEST] (flit_to_west[i][j]);
@@ -82,28 +87,67 @@ void NoximNoC::buildMesh()
 
 	    // Map buffer level signals (analogy with req_tx/rx port mapping)
 	    t[i][j]->free_slots[DIRECTION_NORTH] (free_slots_to_north[i][j]);
-	    t[i][j]->free_slots[DIRECTION_EAST] (free_slots_to_east[i + 1][j]);
-	    t[i][j]->free_slots[DIRECTION_SOUTH] (free_slots_to_south[i][j + 1]);
+	    t[i][j]->free_slots[DIRECTION_EAST] (free_slots_to_east[ei][j]);
+	    t[i][j]->free_slots[DIRECTION_SOUTH] (free_slots_to_south[i][sj]);
 	    t[i][j]->free_slots[DIRECTION_WEST] (free_slots_to_west[i][j]);
 
 	    t[i][j]->free_slots_neighbor[DIRECTION_NORTH] (free_slots_to_south[i][j]);
-	    t[i][j]->free_slots_neighbor[DIRECTION_EAST] (free_slots_to_west[i + 1][j]);
-	    t[i][j]->free_slots_neighbor[DIRECTION_SOUTH] (free_slots_to_north[i][j + 1]);
+	    t[i][j]->free_slots_neighbor[DIRECTION_EAST] (free_slots_to_west[ei][j]);
+	    t[i][j]->free_slots_neighbor[DIRECTION_SOUTH] (free_slots_to_north[i][sj]);
 	    t[i][j]->free_slots_neighbor[DIRECTION_WEST] (free_slots_to_east[i][j]);
 
+	    // Map credit signals (analogy with free slots mapping)
+	    t[i][j]->credits[DIRECTION_NORTH] (credits_to_north[i][j]);
+	    t[i][j]->credits[DIRECTION_EAST] (credits_to_east[ei][j]);
+	    t[i][j]->credits[DIRECTION_SOUTH] (credits_to_south[i][sj]);
+	    t[i][j]->credits[DIRECTION_WEST] (credits_to_west[i][j]);
+
+	    t[i][j]->credits_neighbor[DIRECTION_NORTH] (credits_to_south[i][j]);
+	    t[i][j]->credits_neighbor[DIRECTION_EAST] (credits_to_west[ei][j]);
+	    t[i][j]->credits_neighbor[DIRECTION_SOUTH] (credits_to_north[i][sj]);
+	    t[i][j]->credits_neighbor[DIRECTION_WEST] (credits_to_east[i][j]);
+
 	    // NoP 
 	    t[i][j]->NoP_data_out[DIRECTION_NORTH] (NoP_data_to_north[i][j]);
-	    t[i][j]->NoP_data_out[DIRECTION_EAST] (NoP_data_to_east[i + 1][j]);
-	    t[i][j]->NoP_data_out[DIRECTION_SOUTH] (NoP_data_to_south[i][j + 1]);
+	    t[i][j]->NoP_data_out[DIRECTION_EAST] (NoP_data_to_east[ei][j]);
+	    t[i][j]->NoP_data_out[DIRECTION_SOUTH] (NoP_data_to_south[i][sj]);
 	    t[i][j]->NoP_data_out[DIRECTION_WEST] (NoP_data_to_west[i][j]);
 
 	    t[i][j]->NoP_data_in[DIRECTION_NORTH] (NoP_data_to_south[i][j]);
-	    t[i][j]->NoP_data_in[DIRECTION_EAST] (NoP_data_to_west[i + 1][j]);
-	    t[i][j]->NoP_data_in[DIRECTION_SOUTH] (NoP_data_to_north[i][j + 1]);
+	    t[i][j]->NoP_data_in[DIRECTION_EAST] (NoP_data_to_west[ei][j]);
+	    t[i][j]->NoP_data_in[DIRECTION_SOUTH] (NoP_data_to_north[i][sj]);
 	    t[i][j]->NoP_data_in[DIRECTION_WEST] (NoP_data_to_east[i][j]);
+
+	    // Regional congestion (analogy with NoP mapping)
+	    t[i][j]->congestion_out[DIRECTION_NORTH] (congestion_to_north[i][j]);
+	    t[i][j]->congestion_out[DIRECTION_EAST] (congestion_to_east[ei][j]);
+	    t[i][j]->congestion_out[DIRECTION_SOUTH] (congestion_to_south[i][sj]);
+	    t[i][j]->congestion_out[DIRECTION_WEST] (congestion_to_west[i][j]);
+
+	    t[i][j]->congestion_in[DIRECTION_NORTH] (congestion_to_south[i][j]);
+	    t[i][j]->congestion_in[DIRECTION_EAST] (congestion_to_west[ei][j]);
+	    t[i][j]->congestion_in[DIRECTION_SOUTH] (congestion_to_north[i][sj]);
+	    t[i][j]->congestion_in[DIRECTION_WEST] (congestion_to_east[i][j]);
+
+	    // SMART bypass (analogy with NoP mapping)
+	    t[i][j]->smart_out[DIRECTION_NORTH] (smart_to_north[i][j]);
+	    t[i][j]->smart_out[DIRECTION_EAST] (smart_to_east[ei][j]);
+	    t[i][j]->smart_out[DIRECTION_SOUTH] (smart_to_south[i][sj]);
+	    t[i][j]->smart_out[DIRECTION_WEST] (smart_to_west[i][j]);
+
+	    t[i][j]->smart_in[DIRECTION_NORTH] (smart_to_south[i][j]);
+	    t[i][j]->smart_in[DIRECTION_EAST] (smart_to_west[ei][j]);
+	    t[i][j]->smart_in[DIRECTION_SOUTH] (smart_to_north[i][sj]);
+	    t[i][j]->smart_in[DIRECTION_WEST] (smart_to_east[i][j]);
 	}
     }
 
+    buildExpressLinks();
+
+    // Tori have no borderline nodes to be tied off
+    if (NoximGlobalParams::topology != TOPOLOGY_MESH)
+	return;
+
     // dummy NoximNoP_data structure
     NoximNoP_data tmp_NoP;
 
@@ -127,6 +171,13 @@ void NoximNoC::buildMesh()
 	NoP_data_to_south[i][0].write(tmp_NoP);
 	NoP_data_to_north[i][NoximGlobalParams::mesh_dim_y].write(tmp_NoP);
 
+	congestion_to_south[i][0].write(0.0);
+	congestion_to_north[i][NoximGlobalParams::mesh_dim_y].write(0.0);
+
+	// nothing to bypass and no room beyond the border
+	smart_to_south[i][0].write(NoximSmartLink());
+	smart_to_north[i][NoximGlobalParams::mesh_dim_y].write(NoximSmartLink());
+
     }
 
     for (int j = 0; j <= NoximGlobalParams::mesh_dim_y; j++) {
@@ -141,16 +192,145 @@ void NoximNoC::buildMesh()
 	NoP_data_to_east[0][j].write(tmp_NoP);
 	NoP_data_to_west[NoximGlobalParams::mesh_dim_x][j].write(tmp_NoP);
 
+	congestion_to_east[0][j].write(0.0);
+	congestion_to_west[NoximGlobalParams::mesh_dim_x][j].write(0.0);
+
+	smart_to_east[0][j].write(NoximSmartLink());
+	smart_to_west[NoximGlobalParams::mesh_dim_x][j].write(NoximSmartLink());
+
     }
 
-    // invalidate reservation table entries for non-exhistent channels
-    for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++) {
-	t[i][0]->r->reservation_table.invalidate(DIRECTION_NORTH);
-	t[i][NoximGlobalParams::mesh_dim_y - 1]->r->reservation_table.invalidate(DIRECTION_SOUTH);
+    // The reservation table entries of the non-existent channels are
+    // invalidated by the routers themselves, on every virtual channel
+}
+
+void NoximNoC::createTile(const int i, const int j)
+{
+    // Create the single Tile with a proper name
+    char tile_name[20];
+    sprintf(tile_name, "Tile[%02d][%02d]", i, j);
+    t[i][j] = new NoximTile(tile_name);
+
+    // Tell to the router its coordinates
+    t[i][j]->r->configure(j * NoximGlobalParams::mesh_dim_x + i,
+			  NoximGlobalParams::stats_warm_up_time,
+			  NoximGlobalParams::buffer_depth,
+			  grtable, gtopology);
+
+    // Tell to the PEs their ids, consecutive for each router
+    for (int k = 0; k < NoximGlobalParams::concentration; k++) {
+	NoximProcessingElement *pe = t[i][j]->pe[k];
+
+	pe->local_id = (j * NoximGlobalParams::mesh_dim_x + i) *
+	    NoximGlobalParams::concentration + k;
+	pe->traffic_table = &gttable;	// Needed to choose destination
+	pe->never_transmit = (gttable.occurrencesAsSource(pe->local_id) == 0);
+	pe->mapper = mappers[0];	// The reference mapping
     }
-    for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
-	t[0][j]->r->reservation_table.invalidate(DIRECTION_WEST);
-	t[NoximGlobalParams::mesh_dim_x - 1][j]->r->reservation_table.invalidate(DIRECTION_EAST);
+
+    // Map clock and reset
+    t[i][j]->clock(clock);
+    t[i][j]->reset(reset);
+}
+
+void NoximNoC::buildGraph()
+{
+    // Tiles keep the coordinates of the dimx x dimy matrix, which are
+    // used by the traffic distributions, but they are only connected
+    // through the links of the topology file
+    for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++)
+	for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++)
+	    createTile(i, j);
+
+    // The ports of a tile are numbered as in the topology file, the
+    // express ones after the mesh ones
+    for (int id = 0; id < NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y; id++) {
+	NoximCoord src = id2Coord(id);
+
+	for (int port = 0; port < MAX_GRAPH_PORTS; port++) {
+	    NoximChannelSignals *ch = new NoximChannelSignals;
+	    channels.push_back(ch);
+
+	    // A port without link is looped back on itself and never used,
+	    // the router has tied it off
+	    NoximCoord dst = src;
+	    int dst_port = port;
+
+	    int neighbor = gtopology.getNeighbor(id, port);
+	    if (neighbor != NOT_VALID) {
+		dst = id2Coord(neighbor);
+		dst_port = gtopology.getNeighborPort(id, port);
+	    }
+
+	    // Sender side of the channel
+	    NoximTile *tx = t[src.x][src.y];
+	    tx->req_tx[port] (ch->req);
+	    tx->flit_tx[port] (ch->flit);
+	    tx->ack_tx[port] (ch->ack);
+	    tx->free_slots_neighbor[port] (ch->free_slots);
+
+	    // Receiver side of the channel
+	    NoximTile *rx = t[dst.x][dst.y];
+	    rx->req_rx[dst_port] (ch->req);
+	    rx->flit_rx[dst_port] (ch->flit);
+	    rx->ack_rx[dst_port] (ch->ack);
+	    rx->free_slots[dst_port] (ch->free_slots);
+
+	    // Only the mesh ports have the side networks, which graphs do
+	    // not use: each end is bound on its own
+	    if (port < DIRECTIONS) {
+		tx->credits_neighbor[port] (ch->credits);
+		tx->NoP_data_out[port] (ch->NoP_data);
+		tx->congestion_out[port] (ch->congestion);
+		tx->smart_out[port] (ch->smart);
+	    }
+	    if (dst_port < DIRECTIONS) {
+		rx->credits[dst_port] (ch->credits);
+		rx->NoP_data_in[dst_port] (ch->NoP_data);
+		rx->congestion_in[dst_port] (ch->congestion);
+		rx->smart_in[dst_port] (ch->smart);
+	    }
+	}
+    }
+}
+
+void NoximNoC::buildExpressLinks()
+{
+    // The express ports of every tile are bound: the ones without an
+    // express link are looped back on themselves and never used
+    for (int id = 0; id < NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y; id++) {
+	NoximCoord src = id2Coord(id);
+
+	for (int d = 0; d < EXPRESS_DIRECTIONS; d++) {
+	    NoximChannelSignals *ch = new NoximChannelSignals;
+	    channels.push_back(ch);
+
+	    NoximCoord dst = src;
+	    int dst_d = d;
+
+	    int neighbor = expressNeighbor(id, d);
+	    if (neighbor != NOT_VALID) {
+		dst = id2Coord(neighbor);
+		dst_d = (d + 2) % EXPRESS_DIRECTIONS;	// opposite direction
+	    }
+
+	    int port = DIRECTIONS + d;
+	    int dst_port = DIRECTIONS + dst_d;
+
+	    // Sender side of the channel
+	    NoximTile *tx = t[src.x][src.y];
+	    tx->req_tx[port] (ch->req);
+	    tx->flit_tx[port] (ch->flit);
+	    tx->ack_tx[port] (ch->ack);
+	    tx->free_slots_neighbor[port] (ch->free_slots);
+
+	    // Receiver side of the channel
+	    NoximTile *rx = t[dst.x][dst.y];
+	    rx->req_rx[dst_port] (ch->req);
+	    rx->flit_rx[dst_port] (ch->flit);
+	    rx->ack_rx[dst_port] (ch->ack);
+	    rx->free_slots[dst_port] (ch->free_slots);
+	}
     }
 }
 
@@ -164,188 +344,380 @@ NoximTile *NoximNoC::searchNode(const int id) const
     return false;
 }
 
-void NoximNoC::generate_arrivals ()
+NoximProcessingElement *NoximNoC::searchPE(const int id) const
 {
-	double cycle = NoximGlobalParams::stats_warm_up_time + DEFAULT_RESET_TIME;	
-	initial_parameters();
-	APPLICATION temp_app;
-	for (int i=0; i<NPROCS; i++) {
-		temp_app.app_id = i;
-		temp_app.arrival = cycle;
-		temp_app.lifetime = choose_lifetime ();
-		temp_app.A = choose_parallelism ();
-		temp_app.sig = choose_sigma ();
-		cycle += choose_from_exponential ();
-		app_queue.insert (std::pair<int, APPLICATION>((int)cycle, temp_app));
-		cout << temp_app.arrival <<": "<< temp_app.app_id <<" "<<temp_app.lifetime << endl; 
-  	}
-  	//int s[10];
-  	//for (int i = 0; i < 10000; i++)
-  		//cout << choose_from_log_uniform(1, 10) << endl;
-  		//cout << drandom () << endl;
-}
+    NoximCoord coord = id2Coord(peRouterId(id));
 
-void NoximNoC::mapping(){
-	if (reset.read()){
-		t_money = NoximGlobalParams::mesh_dim_x*NoximGlobalParams::mesh_dim_y/LN;
-	}
-	else{
-		//random_mapping();
-		//dist_mapping();
-		moc_mapping();
-	}
+    return t[coord.x][coord.y]->pe[peIndex(id)];
 }
-void NoximNoC::random_mapping(){
-	/*int time = (int)sc_time_stamp().to_double() / 1000;
-	int n_core = 8;
-	deque <int> idle_core;
 
-	if (app_queue.find(time) != app_queue.end()){
-		waiting_queue.push_back(app_queue[time]);
-	}
-	while (waiting_queue.size() != 0){
-		for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++) {
-			for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
-				if (!t[i][j]->pe->occupied){
-					idle_core.push_back(t[i][j]->pe->local_id);
-		    	}
-			}
-		}
+bool NoximNoC::downstreamInput(const int id, const int port_out,
+				int &next_id, int &next_port)
+{
+    int express = DIRECTIONS + NoximGlobalParams::concentration;
+
+    if (port_out >= DIRECTIONS && port_out < express)
+	return false;
+
+    if (NoximGlobalParams::topology == TOPOLOGY_GRAPH) {
+	int port = graphPort(port_out);
+	next_id = gtopology.getNeighbor(id, port);
+	if (next_id == NOT_VALID)
+	    return false;
+	next_port = graphRouterPort(gtopology.getNeighborPort(id, port));
+	return true;
+    }
 
-		if (idle_core.size() >= n_core){
-			random_shuffle(idle_core.begin(), idle_core.end());
-			deque <int> core_list;
-			for (int i = 0; i < n_core; i++){
-				core_list.push_back(idle_core[i]);
-			}
-			cout << "Time " << time;
-			cout << " Mapping App:";
-			cout << waiting_queue.at(0).app_id <<" ";
-			int t_time = (int)waiting_queue.at(0).arrival;
-			app_queue[t_time].mapToCore(core_list);
-			waiting_queue.pop_front();
-			for (int i = 0; i < core_list.size(); i++){
-				int x = id2Coord(core_list[i]).x;
-				int y = id2Coord(core_list[i]).y;
-				t[x][y]->pe->mapTask(app_queue[time]);
-				cout << core_list[i] <<" ";
-			}
-			cout << "Speedup is " << app_queue[t_time].Sa(core_list.size()) << endl;
-			//cout << "Parameters: " << app_queue[t_time].A << " " << app_queue[t_time].sig<< endl;
-		}
-		else
-			break;
-	}*/
+    if (port_out >= express) {
+	int d = port_out - express;
+	next_id = expressNeighbor(id, d);
+	next_port = express + (d + 2) % EXPRESS_DIRECTIONS;
+	return next_id != NOT_VALID;
+    }
+
+    NoximCoord next = id2Coord(id);
+    switch (port_out) {
+    case DIRECTION_NORTH:
+	next.y--;
+	break;
+    case DIRECTION_EAST:
+	next.x++;
+	break;
+    case DIRECTION_SOUTH:
+	next.y++;
+	break;
+    case DIRECTION_WEST:
+	next.x--;
+	break;
+    }
+
+    if (NoximGlobalParams::topology != TOPOLOGY_MESH) {
+	next.x = (next.x + NoximGlobalParams::mesh_dim_x) %
+	    NoximGlobalParams::mesh_dim_x;
+	next.y = (next.y + NoximGlobalParams::mesh_dim_y) %
+	    NoximGlobalParams::mesh_dim_y;
+    } else if (next.x < 0 || next.x >= NoximGlobalParams::mesh_dim_x ||
+	       next.y < 0 || next.y >= NoximGlobalParams::mesh_dim_y)
+	return false;
+
+    next_id = coord2Id(next);
+    next_port = (port_out + 2) % DIRECTIONS;	// opposite direction
+    return true;
 }
 
-bool MyCompare(const PEPrice& d1, const PEPrice& d2)
+void NoximNoC::deadlockWatchdog()
 {
-	return d1.price > d2.price;
-}
+    double now = sc_time_stamp().to_double() / 1000;
+
+    if (reset.read()) {
+	deadlocks = 0;
+	deadlock_found = false;
+	next_deadlock_check = DEFAULT_RESET_TIME +
+	    NoximGlobalParams::deadlock_check_period;
+	return;
+    }
+
+    if (now < next_deadlock_check)
+	return;
+    next_deadlock_check = now + NoximGlobalParams::deadlock_check_period;
+
+    // The nodes of the wait-for graph are the input virtual channels
+    // holding some flit
+    int n_vcs = NoximGlobalParams::virtual_channels;
+    int n_slots = MAX_ROUTER_PORTS * n_vcs;
+    int n_routers = NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y;
+
+    vector <int> node_of(n_routers * n_slots, NOT_VALID);
+    vector <NoximRouter *> node_router;
+    vector <int> node_input;
+    for (int id = 0; id < n_routers; id++) {
+	NoximCoord c = id2Coord(id);
+	NoximRouter *r = t[c.x][c.y]->r;
+	for (int vi = 0; vi < n_slots; vi++)
+	    if (!r->buffer[vi / n_vcs][vi % n_vcs].IsEmpty()) {
+		node_of[id * n_slots + vi] = node_router.size();
+		node_router.push_back(r);
+		node_input.push_back(vi);
+	    }
+    }
 
-void NoximNoC::dist_mapping(){
-/*	int time = (int)sc_time_stamp().to_double() / 1000;
-	deque <int> idle_core;
-
-	if (time % interval == 0){
-		vector <PEPrice> pep;
-		for (int i = 0; i < NoximGlobalParams::mesh_dim_x*NoximGlobalParams::mesh_dim_y; i++){
-			int x = id2Coord(i).x;
-			int y = id2Coord(i).y;
-			if (t[x][y]->pe->price > 0){
-				PEPrice temp;
-				temp.p_id = t[x][y]->pe->local_id;
-				temp.price = t[x][y]->pe->price;				
-			}
-			pep.push_back(temp);
+    // A node waits on some output virtual channels and may proceed as
+    // soon as any of them does. An output is held either by another
+    // input of the same router or, when the node holds it, by the full
+    // buffer of the next router.
+    int n_nodes = node_router.size();
+    vector < vector <int> > waits_for(n_nodes);
+    vector <bool> blocked(n_nodes, true);
+    for (int n = 0; n < n_nodes && n_nodes > 0; n++) {
+	NoximRouter *r = node_router[n];
+	int vi = node_input[n];
+	vector <int> outputs = r->waitedOutputs(vi / n_vcs, vi % n_vcs);
+
+	if (outputs.empty())
+	    blocked[n] = false;
+
+	for (unsigned int k = 0; k < outputs.size() && blocked[n]; k++) {
+	    int vo = outputs[k];
+	    int owner = r->reservation_table.getInputPort(vo);
+	    int next = NOT_VALID;
+
+	    if (owner == NOT_RESERVED)
+		blocked[n] = false;
+	    else if (owner == NOT_VALID)
+		continue;	// never going to be granted
+	    else if (owner != vi)
+		next = node_of[r->local_id * n_slots + owner];
+	    else {
+		int next_id, next_port;
+		int vc_out = vo % n_vcs;
+		if (downstreamInput(r->local_id, vo / n_vcs, next_id, next_port)) {
+		    NoximCoord c = id2Coord(next_id);
+		    if (t[c.x][c.y]->r->buffer[next_port][vc_out].IsFull())
+			next = node_of[next_id * n_slots + next_port * n_vcs + vc_out];
 		}
-		std::sort(pep.begin(), pep.end(), MyCompare);
-		cout << "Sorting... " << endl;
-		for (int i = 0; i < NoximGlobalParams::mesh_dim_x*NoximGlobalParams::mesh_dim_y; i++){
-			cout << pep[i].p_id << " " << pep[i].price << endl;
+	    }
+
+	    if (next == NOT_VALID)
+		blocked[n] = false;
+	    else
+		waits_for[n].push_back(next);
+	}
+    }
+
+    // Whatever waits for a node that can proceed will proceed too: the
+    // nodes left blocked are deadlocked
+    bool changed = true;
+    while (changed) {
+	changed = false;
+	for (int n = 0; n < n_nodes; n++)
+	    for (unsigned int k = 0; k < waits_for[n].size() && blocked[n]; k++)
+		if (!blocked[waits_for[n][k]]) {
+		    blocked[n] = false;
+		    changed = true;
 		}
+    }
+
+    vector <int> deadlocked;
+    for (int n = 0; n < n_nodes; n++)
+	if (blocked[n])
+	    deadlocked.push_back(n);
+
+    if (deadlocked.empty()) {
+	deadlock_found = false;
+	return;
+    }
+
+    // A deadlock lasting over several checks is reported once
+    if (!deadlock_found) {
+	deadlocks++;
+
+	cout << now << ": deadlock among " <<
+	    deadlocked.size() << " channels" << endl;
+	for (unsigned int k = 0; k < deadlocked.size(); k++) {
+	    NoximRouter *r = node_router[deadlocked[k]];
+	    int vi = node_input[deadlocked[k]];
+	    vector <int> outputs = r->waitedOutputs(vi / n_vcs, vi % n_vcs);
+
+	    cout << "   Router[" << r->local_id << "], Input[" << vi / n_vcs <<
+		"] VC " << vi % n_vcs << " waits for";
+	    for (unsigned int o = 0; o < outputs.size(); o++)
+		cout << " Output[" << outputs[o] / n_vcs << "] VC " <<
+		    outputs[o] % n_vcs;
+	    cout << ", flit: " << r->buffer[vi / n_vcs][vi % n_vcs].Front() << endl;
+	}
+    }
+    deadlock_found = true;
+
+    switch (NoximGlobalParams::deadlock_action) {
+    case DEADLOCK_ABORT:
+	cout << "Simulation aborted because of a deadlock" << endl;
+	sc_stop();
+	break;
+
+    case DEADLOCK_DRAIN:
+	// Every wait chain ends with a head still to be allocated: its
+	// packet is dropped and the network checked again in the next
+	// cycle, until the deadlock is gone
+	for (unsigned int k = 0; k < deadlocked.size(); k++) {
+	    NoximRouter *r = node_router[deadlocked[k]];
+	    int vi = node_input[deadlocked[k]];
+	    if (r->buffer[vi / n_vcs][vi % n_vcs].Front().flit_type == FLIT_TYPE_HEAD
+		&& r->reservation_table.getOutputPort(vi) == NOT_RESERVED) {
+		r->drainPacket(vi / n_vcs, vi % n_vcs);
+		next_deadlock_check = now + 1;
+		break;
+	    }
 	}
+	break;
+    }
+}
 
-	if (app_queue.find(time) != app_queue.end()){
-		
-	}*/
+// Relative half-width of the 95% confidence interval of the mean of
+// the (batch) samples
+static double relativeHalfWidth(const vector <double> & samples)
+{
+    // Student's t quantiles for 1..30 degrees of freedom
+    static const double t975[] = {
+	12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+	2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101,
+	2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052,
+	2.048, 2.045, 2.042
+    };
+
+    int n = samples.size();
+    if (n < 2)
+	return 1.0;
+
+    double mean = 0.0;
+    for (int i = 0; i < n; i++)
+	mean += samples[i];
+    mean /= n;
+
+    double var = 0.0;
+    for (int i = 0; i < n; i++)
+	var += (samples[i] - mean) * (samples[i] - mean);
+    var /= n - 1;
+
+    if (mean == 0.0)
+	return var == 0.0 ? 0.0 : 1.0;
+
+    double t = n - 1 <= 30 ? t975[n - 2] : 1.96;
+    return t * sqrt(var / n) / mean;
 }
 
-void NoximNoC::initial_mapping(){
-	int time = (int)sc_time_stamp().to_double() / 1000;
-	if (app_queue.find(time) != app_queue.end()){
-		waiting_queue.push_back(app_queue[time]);
-	}
+// True if the samples keep growing: the least squares line through
+// them rises, over the observed batches, by more than their mean
+static bool diverging(const vector <double> & samples)
+{
+    int n = samples.size();
+    double mean_x = (n - 1) / 2.0;
+    double mean_y = 0.0;
+    for (int i = 0; i < n; i++)
+	mean_y += samples[i];
+    mean_y /= n;
+
+    double sxy = 0.0, sxx = 0.0;
+    for (int i = 0; i < n; i++) {
+	sxy += (i - mean_x) * (samples[i] - mean_y);
+	sxx += (i - mean_x) * (i - mean_x);
+    }
 
-	// initial mapping when new application arrives
-	while (waiting_queue.size() != 0){
-		int arrival = (int)waiting_queue[0].arrival;
-		int pe_id = free_pe[free_pe.size()-1].id;
-		int x = id2Coord(pe_id).x;
-		int y = id2Coord(pe_id).y;
-		app_queue[arrival].ini_mapping(pe_id, time);
-		t[x][y]->pe->mapTask(time, time + app_queue[arrival].lifetime);
-	}
+    return sxx > 0.0 && sxy / sxx * (n - 1) > mean_y;
 }
 
-void NoximNoC::idle_core_price_sort(){
-	int time = (int)sc_time_stamp().to_double() / 1000;
-	if (time % INTERVAL == 0){
-		for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++) {
-			for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
-				if ((!t[i][j]->pe->occupied) && (t[i][j]->pe->price > 0)){
-					PEPrice temp;
-					temp.id = t[i][j]->pe->local_id;
-					temp.price = t[i][j]->pe->price;
-					free_pe.push_back(temp);
-					//idle_core.push_back(t[i][j]->pe->local_id);
-		    	}
-			}
-		}
-		std::sort(free_pe.begin(), free_pe.end(), MyCompare);
-		cout << "Sorting... " << endl;
-		for (int i = 0; i < free_pe.size(); i++){
-			cout << free_pe[i].id << " " << free_pe[i].price << endl;
-		}
+void NoximNoC::convergenceMonitor()
+{
+    double now = sc_time_stamp().to_double() / 1000;
+
+    if (reset.read()) {
+	convergence = CONVERGENCE_RUNNING;
+	batch_delays.clear();
+	batch_throughputs.clear();
+	delay_precision = throughput_precision = 1.0;
+	next_batch_end = DEFAULT_RESET_TIME +
+	    NoximGlobalParams::stats_warm_up_time +
+	    NoximGlobalParams::convergence_batch;
+	batch_packets = batch_flits = 0;
+	batch_delay = 0.0;
+	settling_batch = false;
+	return;
+    }
+
+    if (now < next_batch_end || convergence != CONVERGENCE_RUNNING)
+	return;
+    next_batch_end = now + NoximGlobalParams::convergence_batch;
+
+    unsigned long packets = 0;
+    unsigned long flits = 0;
+    double delay = 0.0;
+    for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++)
+	for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
+	    packets += t[i][j]->r->stats.getReceivedPackets();
+	    flits += t[i][j]->r->stats.getReceivedFlits();
+	    delay += t[i][j]->r->stats.getTotalDelay();
 	}
+
+    // Batches without any packet carry no delay sample
+    if (!settling_batch) {
+	if (packets > batch_packets)
+	    batch_delays.push_back((delay - batch_delay) /
+				   (packets - batch_packets));
+	batch_throughputs.push_back((double) (flits - batch_flits) /
+				    NoximGlobalParams::convergence_batch);
+    }
+    settling_batch = false;
+    batch_packets = packets;
+    batch_flits = flits;
+    batch_delay = delay;
+
+    if ((int) batch_throughputs.size() < CONVERGENCE_MIN_BATCHES)
+	return;
+
+    delay_precision = relativeHalfWidth(batch_delays);
+    throughput_precision = relativeHalfWidth(batch_throughputs);
+
+    if ((int) batch_delays.size() >= CONVERGENCE_MIN_BATCHES &&
+	diverging(batch_delays))
+	convergence = CONVERGENCE_UNSTABLE;
+    else if (delay_precision <= NoximGlobalParams::convergence_precision &&
+	     throughput_precision <= NoximGlobalParams::convergence_precision)
+	convergence = CONVERGENCE_REACHED;
+
+    // The saturation search drives the simulation by itself
+    if (NoximGlobalParams::saturation_search_tolerance > 0.0)
+	return;
+
+    if (convergence == CONVERGENCE_UNSTABLE) {
+	cout << now << ": packet delay diverging, the network is saturated" << endl;
+	sc_stop();
+    } else if (convergence == CONVERGENCE_REACHED) {
+	cout << now << ": converged after " << batch_throughputs.size() <<
+	    " batches" << endl;
+	sc_stop();
+    }
 }
 
-void NoximNoC::update_running_app(){
-	for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++) {
-		for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
-			if (t[i][j]->pe->occupied){
-				//int app_t = t[i][j]->pe->app.arrival;
-				int app_t = t[i][j]->pe->arrival;
-				if (find(running_app.begin(), running_app.end(), app_t) == running_app.end()){
-					running_app.push_back(app_t);
-				}
-			}
-		}
-	}
+void NoximNoC::restartConvergence()
+{
+    convergence = CONVERGENCE_RUNNING;
+    batch_delays.clear();
+    batch_throughputs.clear();
+    delay_precision = throughput_precision = 1.0;
+    next_batch_end = sc_time_stamp().to_double() / 1000 +
+	NoximGlobalParams::convergence_batch;
+    settling_batch = true;
 }
 
-void NoximNoC::update_money(){
-	for (int i = 0; i < running_app.size(); i++){
-		int arrival = running_app[i];
-		app_queue[arrival].money_allowed = 1/running_app.size();
-		//running_app[i].money_allowed = 1/running_app.size();
+void NoximNoC::mapping(){
+	if (reset.read()){
+		t_money = peCount()/LN;
+		for (unsigned int i = 0; i < mappers.size(); i++)
+			mappers[i]->reset(DEFAULT_RESET_TIME);
+	}
+	else{
+		double now = sc_time_stamp().to_double() / 1000;
+		// the routers heat the tiles of every mapping alike
+		if (NoximGlobalParams::thermal_model &&
+		    (int) now % INTERVAL == INTERVAL - 1)
+			addRouterEnergy();
+		for (unsigned int i = 0; i < mappers.size(); i++)
+			mappers[i]->advanceTo(now);
 	}
 }
 
-void NoximNoC::moc_mapping(){
-	idle_core_price_sort();
-	update_running_app();
-	update_money();
-	int time = (int)sc_time_stamp().to_double() / 1000;
-	//if (time % 1000 == 0){
-		for (int r = 0; r < running_app.size(); r++){
-			int arrival = running_app[r];
-			if (app_queue[arrival].money_used < app_queue[arrival].money_allowed){
-				app_queue[arrival].expand(t);
-			}
-			else {
-				app_queue[arrival].shrink(t);
-			}
-		}
-	//}
+void NoximNoC::addRouterEnergy()
+{
+    int n_routers = NoximGlobalParams::mesh_dim_x *
+	NoximGlobalParams::mesh_dim_y;
+    if ((int) router_energy.size() != n_routers)
+	router_energy.assign(n_routers, 0.0);
+
+    for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+	for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++) {
+	    int r = y * NoximGlobalParams::mesh_dim_x + x;
+	    double energy = t[x][y]->r->getPower();
+	    for (unsigned int i = 0; i < mappers.size(); i++)
+		mappers[i]->addRouterEnergy(r, energy - router_energy[r]);
+	    router_energy[r] = energy;
+	}
 }
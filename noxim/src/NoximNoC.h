@@ -15,14 +15,31 @@
 #include <map>
 #include <vector>
 #include <deque>
+#include <queue>
+#include <functional>
 #include <algorithm>
 #include "NoximApp.h"
 #include "NoximTile.h"
 #include "NoximGlobalRoutingTable.h"
 #include "NoximGlobalTrafficTable.h"
+#include "NoximGlobalTopology.h"
+#include "NoximMapper.h"
 
 using namespace std;
 
+// NoximChannelSignals -- Signals of a channel between two routers of a
+// graph topology or of an express link
+struct NoximChannelSignals {
+    sc_signal <bool> req;
+    sc_signal <bool> ack;
+    sc_signal <NoximFlitBundle> flit;
+    sc_signal <int> free_slots;
+    sc_signal <NoximCreditCount> credits;
+    sc_signal <NoximNoP_data> NoP_data;
+    sc_signal <double> congestion;
+    sc_signal <NoximSmartLink> smart;
+};
+
 SC_MODULE(NoximNoC)
 {
 
@@ -41,51 +58,80 @@ SC_MODULE(NoximNoC)
     sc_signal <bool> ack_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
     sc_signal <bool> ack_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
 
-    sc_signal <NoximFlit> flit_to_east[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <NoximFlit> flit_to_west[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <NoximFlit> flit_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <NoximFlit> flit_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <NoximFlitBundle> flit_to_east[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <NoximFlitBundle> flit_to_west[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <NoximFlitBundle> flit_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <NoximFlitBundle> flit_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
 
     sc_signal <int> free_slots_to_east[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
     sc_signal <int> free_slots_to_west[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
     sc_signal <int> free_slots_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
     sc_signal <int> free_slots_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
 
+    sc_signal <NoximCreditCount> credits_to_east[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <NoximCreditCount> credits_to_west[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <NoximCreditCount> credits_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <NoximCreditCount> credits_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+
     // NoP
     sc_signal <NoximNoP_data> NoP_data_to_east[MAX_STATIC_DIM][MAX_STATIC_DIM];
     sc_signal <NoximNoP_data> NoP_data_to_west[MAX_STATIC_DIM][MAX_STATIC_DIM];
     sc_signal <NoximNoP_data> NoP_data_to_south[MAX_STATIC_DIM][MAX_STATIC_DIM];
     sc_signal <NoximNoP_data> NoP_data_to_north[MAX_STATIC_DIM][MAX_STATIC_DIM];
 
+    // Regional congestion
+    sc_signal <double> congestion_to_east[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <double> congestion_to_west[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <double> congestion_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <double> congestion_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+
+    // SMART bypass
+    sc_signal <NoximSmartLink> smart_to_east[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <NoximSmartLink> smart_to_west[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <NoximSmartLink> smart_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    sc_signal <NoximSmartLink> smart_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+
     // Matrix of tiles
     NoximTile *t[MAX_STATIC_DIM][MAX_STATIC_DIM];
 
     // Global tables
     NoximGlobalRoutingTable grtable;
     NoximGlobalTrafficTable gttable;
+    NoximGlobalTopology gtopology;
+
+    // Channels of a graph topology
+    vector <NoximChannelSignals *> channels;
 
     // Variables for lifetime reliability
     double t_money;
     double price[MAX_STATIC_DIM][MAX_STATIC_DIM];
-    //Mapping
-    map<int, APPLICATION> app_queue;
-    deque <APPLICATION> waiting_queue;
-
-    void generate_arrivals ();
+    // One mapper per policy, all of them replaying the same trace. The
+    // first one is the reference.
+    vector <NoximMapper *> mappers;
     void mapping();
-    void random_mapping();
-    void dist_mapping();
-
-    // moc algorithm 
-    vector <PEPrice> free_pe;
-    //vector <APPLICATION> running_app;
-    vector<int> running_app;
-    void idle_core_price_sort(); // manage free cores
-    void initial_mapping();
-    void moc_mapping();  // the algorithm in the paper
-    //bool MyCompare(const PEPrice& d1, const PEPrice& d2);
-    void update_running_app();
-    void update_money();
+
+    // Passes the energy of the routers since the last call to the
+    // thermal models of the mappers
+    vector <double> router_energy;
+    void addRouterEnergy();
+
+    // Deadlock watchdog
+    unsigned long deadlocks;	// Deadlocks found so far
+    bool deadlock_found;	// The last check found a deadlock
+    double next_deadlock_check;	// Cycle of the next check
+    void deadlockWatchdog();
+
+    // Steady-state convergence detection, by batch means
+    int convergence;		// CONVERGENCE_RUNNING, _REACHED or _UNSTABLE
+    vector <double> batch_delays;	// Average packet delay of each batch
+    vector <double> batch_throughputs;	// Flits received per cycle in each batch
+    double delay_precision;	// Relative half-widths of the 95% confidence
+    double throughput_precision;	// intervals of the two means
+    void convergenceMonitor();
+
+    // Starts collecting a new series of batches from the current cycle,
+    // the first batch only lets the network settle
+    void restartConvergence();
 
     //---------- Mau experiment <start>
     void flitsMonitor() {
@@ -120,15 +166,43 @@ SC_MODULE(NoximNoC)
     SC_METHOD(mapping);
     sensitive << reset;
     sensitive << clock.pos();
+
+	if (NoximGlobalParams::deadlock_check_period > 0) {
+	    SC_METHOD(deadlockWatchdog);
+	    sensitive << reset;
+	    sensitive << clock.pos();
+	}
+
+	if (NoximGlobalParams::convergence_precision > 0.0) {
+	    SC_METHOD(convergenceMonitor);
+	    sensitive << reset;
+	    sensitive << clock.pos();
+	}
     }
 
     // Support methods
     NoximTile *searchNode(const int id) const;
+    NoximProcessingElement *searchPE(const int id) const;
+
+    // Router and input port reached through output port_out of router
+    // id. Returns false if there is no such link
+    bool downstreamInput(const int id, const int port_out,
+			 int &next_id, int &next_port);
 
 
   private:
 
     void buildMesh();
+    void buildGraph();
+    void buildExpressLinks();
+    void createTile(const int i, const int j);
+
+    // Batch means bookkeeping
+    double next_batch_end;
+    unsigned long batch_packets;	// Packets, flits and delay received
+    unsigned long batch_flits;	// up to the beginning of the
+    double batch_delay;		// current batch
+    bool settling_batch;	// The current batch is not recorded
 
 };
 
@@ -18,8 +18,10 @@ double NoximPower::pwr_routing     = 0.0;
 double NoximPower::pwr_selection   = 0.0;
 double NoximPower::pwr_arbitration = 0.0;
 double NoximPower::pwr_crossbar    = 0.0;
+double NoximPower::pwr_crossbar_flit = 0.0;
 double NoximPower::pwr_link        = 0.0;
 double NoximPower::pwr_link_lv     = 0.0;
+double NoximPower::pwr_link_register = 0.0;
 double NoximPower::pwr_leakage     = 0.0;
 double NoximPower::pwr_end2end     = 0.0;
 
@@ -51,9 +53,15 @@ void NoximPower::Buffering()
   pwr += pwr_buffering;
 }
 
-void NoximPower::Link(bool low_voltage)
+void NoximPower::Link(bool low_voltage, double length)
 {
-  pwr += low_voltage ? pwr_link_lv : pwr_link;
+  // link energies refer to a link spanning one tile
+  pwr += (low_voltage ? pwr_link_lv : pwr_link) * length;
+}
+
+void NoximPower::LinkRegisters(int registers)
+{
+  pwr += pwr_link_register * registers;
 }
 
 void NoximPower::Arbitration()
@@ -66,9 +74,20 @@ void NoximPower::Crossbar()
   pwr += pwr_crossbar;
 }
 
+void NoximPower::CrossbarTraversal()
+{
+  pwr += pwr_crossbar_flit;
+}
+
 void NoximPower::Leakage()
 {
-  pwr += pwr_leakage;
+  // the leakage refers to a router with a single local port and grows
+  // with the number of ports of concentrated routers and express links
+  int ports = DIRECTIONS + NoximGlobalParams::concentration;
+  if (NoximGlobalParams::express_span > 0)
+    ports += EXPRESS_DIRECTIONS;
+
+  pwr += pwr_leakage * ((double) ports / (DIRECTIONS + 1));
 }
 
 void NoximPower::EndToEnd()
@@ -109,10 +128,14 @@ bool NoximPower::LoadPowerData(const char *fname)
 		    pwr_arbitration = value;
 		  else if (strcmp(label, "PWR_CROSSBAR") == 0)
 		    pwr_crossbar = value;
+		  else if (strcmp(label, "PWR_CROSSBAR_FLIT") == 0)
+		    pwr_crossbar_flit = value;
 		  else if (strcmp(label, "PWR_LINK") == 0)
 		    pwr_link = value;
 		  else if (strcmp(label, "PWR_LINK_LV") == 0)
 		    pwr_link_lv = value;
+		  else if (strcmp(label, "PWR_LINK_REGISTER") == 0)
+		    pwr_link_register = value;
 		  else if (strcmp(label, "PWR_LEAKAGE") == 0)
 		    pwr_leakage = value;
 		  else if (strcmp(label, "PWR_END2END") == 0)
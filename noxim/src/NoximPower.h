@@ -58,7 +58,9 @@ class NoximPower {
     void Selection();
     void Arbitration();
     void Crossbar();
-    void Link(bool low_voltage);
+    void CrossbarTraversal();
+    void Link(bool low_voltage, double length);
+    void LinkRegisters(int registers);
     void EndToEnd();
     void Leakage();
 
@@ -88,6 +90,10 @@ class NoximPower {
 	return pwr_crossbar;
     }
 
+    double getCrossbarTraversal() {
+	return pwr_crossbar_flit;
+    }
+
     double getLeakage() {
 	return pwr_leakage;
     }
@@ -99,6 +105,10 @@ class NoximPower {
 	return pwr_link;
     }
 
+    double getPwrLinkRegister() {
+      return pwr_link_register;
+    }
+
     double getPwrEndToEnd() {
       return pwr_end2end;
     }
@@ -110,8 +120,10 @@ class NoximPower {
     static double pwr_selection;
     static double pwr_arbitration;
     static double pwr_crossbar;
+    static double pwr_crossbar_flit;
     static double pwr_link;
     static double pwr_link_lv;
+    static double pwr_link_register;
     static double pwr_leakage;
     static double pwr_end2end;
 
@@ -0,0 +1,104 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the price index of the PEs
+ */
+
+#include "NoximPriceIndex.h"
+
+NoximPriceIndex::NoximPriceIndex()
+{
+    configure(0);
+}
+
+void NoximPriceIndex::configure(const int _n_pes)
+{
+    order.clear();
+    offset = 0.0;
+    key.assign(_n_pes, 0.0);
+    present.assign(_n_pes, false);
+}
+
+void NoximPriceIndex::update(const int id, const double budget)
+{
+    assert(id >= 0 && id < (int) present.size());
+    assert(budget >= 0);
+
+    double k = offset - budget;
+
+    if (present[id]) {
+	if (key[id] == k)
+	    return;
+	order.erase(pair <double, int> (key[id], id));
+    }
+
+    key[id] = k;
+    present[id] = true;
+    order.insert(pair <double, int> (k, id));
+}
+
+void NoximPriceIndex::raise(const double amount)
+{
+    assert(amount >= 0);
+
+    offset += amount;
+}
+
+void NoximPriceIndex::erase(const int id)
+{
+    assert(id >= 0 && id < (int) present.size());
+
+    if (!present[id])
+	return;
+
+    order.erase(pair <double, int> (key[id], id));
+    present[id] = false;
+}
+
+bool NoximPriceIndex::contains(const int id) const
+{
+    return id >= 0 && id < (int) present.size() && present[id];
+}
+
+double NoximPriceIndex::getBudget(const int id) const
+{
+    assert(contains(id));
+
+    return offset - key[id];
+}
+
+double NoximPriceIndex::getPrice(const int id) const
+{
+    return 1 / getBudget(id);
+}
+
+bool NoximPriceIndex::empty() const
+{
+    return order.empty();
+}
+
+int NoximPriceIndex::size() const
+{
+    return order.size();
+}
+
+int NoximPriceIndex::cheapest() const
+{
+    assert(!order.empty());
+
+    return order.begin()->second;
+}
+
+NoximPriceIndex::const_iterator NoximPriceIndex::begin() const
+{
+    return order.begin();
+}
+
+NoximPriceIndex::const_iterator NoximPriceIndex::end() const
+{
+    return order.end();
+}
@@ -0,0 +1,71 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the price index of the PEs
+ */
+
+#ifndef __NOXIMPRICEINDEX_H__
+#define __NOXIMPRICEINDEX_H__
+
+#include <cassert>
+#include <set>
+#include <vector>
+#include "NoximMain.h"
+using namespace std;
+
+// PEs ordered by price, cheapest first. A PE is in the index at most
+// once, so that its price can be changed in O(log N). The price is the
+// inverse of a budget: the index keeps the budgets relative to
+// a common offset, so that all of them can be raised at once.
+class NoximPriceIndex {
+  public:
+
+    typedef set < pair <double, int> >::const_iterator const_iterator;
+
+    NoximPriceIndex();
+
+    // Sets the number of PEs and empties the index
+    void configure(const int _n_pes);
+
+    // Inserts PE id with the price of the given budget, or moves it
+    // there. The budget must not be negative.
+    void update(const int id, const double budget);
+
+    // The budgets of all the PEs in the index rise by amount, which
+    // leaves their order alone. Takes O(1).
+    void raise(const double amount);
+
+    // Removes PE id, if present
+    void erase(const int id);
+
+    bool contains(const int id) const;
+
+    // Budget and price PE id is indexed with. Assert if it is not
+    // present
+    double getBudget(const int id) const;
+    double getPrice(const int id) const;
+
+    bool empty() const;
+    int size() const;
+
+    // Cheapest PE. Asserts if the index is empty
+    int cheapest() const;
+
+    // PEs in ascending order of price, the id being the second field
+    const_iterator begin() const;
+    const_iterator end() const;
+
+  private:
+
+    // (offset - budget, id) pairs: the largest budget comes first
+    set < pair <double, int> > order;
+    double offset;
+    vector <double> key;	// offset - budget of each indexed PE
+    vector <bool> present;
+};
+
+#endif
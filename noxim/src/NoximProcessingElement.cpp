@@ -9,44 +9,7 @@
  */
 
 #include "NoximProcessingElement.h"
-
-void NoximProcessingElement::exProcess(){
-	if (reset.read()){
-		occupied = 0;
-		budget = 0;
-		price = 0;
-		enabled = 1;
-	}
-	else {
-		double now = sc_time_stamp().to_double() / 1000;
-		//if (now - app.mapping_time > app.lifetime){
-		if (now > end){
-			clearTask();
-		}
-		//budget += ((int)now % interval == 0) ? (interval * ln) : 0;
-		if ((int)now % INTERVAL == (INTERVAL - 1)){
-			budget += (LN * INTERVAL);
-			if (budget < 0)
-				enabled = 0;
-			else
-				enabled = 1;
-			price = 1/budget;
-		}
-		budget -= occupied*LC;
-	}
-}
-
-void NoximProcessingElement::mapTask(int s, int e){
-	arrival = s;
-	end = e;
-	occupied = 1;
-}
-
-void NoximProcessingElement::clearTask(){
-	arrival = 0;
-	end = 0;
-	occupied = 0;
-}
+#include "NoximMapper.h"
 
 int NoximProcessingElement::randInt(int min, int max)
 {
@@ -60,10 +23,11 @@ void NoximProcessingElement::rxProcess()
 	current_level_rx = 0;
     } else {
 	if (req_rx.read() == 1 - current_level_rx) {
-	    NoximFlit flit_tmp = flit_rx.read();
+	    NoximFlitBundle bundle_tmp = flit_rx.read();
 	    if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) {
-		cout << sc_simulation_time() << ": ProcessingElement[" <<
-		    local_id << "] RECEIVING " << flit_tmp << endl;
+		for (int k = 0; k < bundle_tmp.size; k++)
+		    cout << sc_simulation_time() << ": ProcessingElement[" <<
+			local_id << "] RECEIVING " << bundle_tmp.flit[k] << endl;
 	    }
 	    current_level_rx = 1 - current_level_rx;	// Negate the old value for Alternating Bit Protocol (ABP)
 	}
@@ -89,13 +53,19 @@ void NoximProcessingElement::txProcess()
 
 	if (ack_tx.read() == current_level_tx) {
 	    if (!packet_queue.empty()) {
-		NoximFlit flit = nextFlit();	// Generate a new flit
-		if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) {
-		    cout << sc_time_stamp().to_double() /
-			1000 << ": ProcessingElement[" << local_id <<
-			"] SENDING " << flit << endl;
+		// Fill the local link with as many flits as it can carry
+		NoximFlitBundle bundle;
+		while (!packet_queue.empty()
+		       && bundle.size < NoximGlobalParams::link_width) {
+		    NoximFlit flit = nextFlit();	// Generate a new flit
+		    if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) {
+			cout << sc_time_stamp().to_double() /
+			    1000 << ": ProcessingElement[" << local_id <<
+			    "] SENDING " << flit << endl;
+		    }
+		    bundle.flit[bundle.size++] = flit;
 		}
-		flit_tx->write(flit);	// Send the generated flit
+		flit_tx->write(bundle);	// Send the generated flits
 		current_level_tx = 1 - current_level_tx;	// Negate the old value for Alternating Bit Protocol (ABP)
 		req_tx.write(current_level_tx);
 	    }
@@ -113,6 +83,7 @@ NoximFlit NoximProcessingElement::nextFlit()
     flit.timestamp = packet.timestamp;
     flit.sequence_no = packet.size - packet.flit_left;
     flit.hop_no = 0;
+    flit.vc_id = 0;
     //  flit.payload     = DEFAULT_PAYLOAD;
     flit.use_low_voltage_path = packet.use_low_voltage_path;
 
@@ -130,12 +101,42 @@ NoximFlit NoximProcessingElement::nextFlit()
     return flit;
 }
 
+void NoximProcessingElement::flushQueue()
+{
+    // a packet already partly injected has to be completed
+    queue < NoximPacket > started;
+    if (!packet_queue.empty() &&
+	packet_queue.front().flit_left < packet_queue.front().size)
+	started.push(packet_queue.front());
+
+    packet_queue = started;
+}
+
 bool NoximProcessingElement::canShot(NoximPacket & packet)
 {
     bool shot;
     double threshold;
 
-    if (NoximGlobalParams::traffic_distribution != TRAFFIC_TABLE_BASED) {
+    if (NoximGlobalParams::traffic_distribution == TRAFFIC_APPLICATION) {
+	// only the PEs running an application inject, in proportion to
+	// the time it spends communicating
+	double rate = applicationRate();
+	if (rate == 0.0)
+	    return false;
+
+	if (!transmittedAtPreviousCycle)
+	    threshold = NoximGlobalParams::packet_injection_rate * rate;
+	else
+	    threshold = NoximGlobalParams::probability_of_retransmission * rate;
+
+	shot = (((double) rand()) / RAND_MAX < threshold);
+	if (shot) {
+	    packet = trafficApplication();
+	    shot = (packet.dst_id != NOT_VALID);
+	    if (shot)
+		setUseLowVoltagePath(packet);
+	}
+    } else if (NoximGlobalParams::traffic_distribution != TRAFFIC_TABLE_BASED) {
 	if (!transmittedAtPreviousCycle)
 	    threshold = NoximGlobalParams::packet_injection_rate;
 	else
@@ -229,9 +230,7 @@ NoximPacket NoximProcessingElement::trafficRandom()
 
     //cout << "\n " << sc_time_stamp().to_double()/1000 << " PE " << local_id << " rnd = " << rnd << endl;
 
-    int max_id =
-	(NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y) -
-	1;
+    int max_id = peCount() - 1;
 
     // Random destination distribution
     do {
@@ -260,19 +259,95 @@ NoximPacket NoximProcessingElement::trafficRandom()
     return p;
 }
 
+const APPLICATION *NoximProcessingElement::mappedApplication()
+{
+    if (mapper == NULL || !mapper->lifetime.isOccupied(local_id))
+	return NULL;
+
+    map <int, APPLICATION>::const_iterator it =
+	mapper->app_queue.find(mapper->lifetime.getApp(local_id));
+    if (it == mapper->app_queue.end())
+	return NULL;
+
+    return &it->second;
+}
+
+double NoximProcessingElement::applicationRate()
+{
+    const APPLICATION *a = mappedApplication();
+    if (a == NULL)
+	return 0.0;
+
+    // an application on n cores runs Sa(n) times as fast as on one:
+    // the rest of their cycles goes into communication
+    int n = a->cores.size();
+    if (n <= 1)
+	return 0.0;
+
+    return max(0.0, 1.0 - a->Sa(n) / n);
+}
+
+NoximPacket NoximProcessingElement::trafficApplication()
+{
+    NoximPacket p;
+    p.src_id = local_id;
+    p.dst_id = NOT_VALID;
+
+    const APPLICATION *a = mappedApplication();
+    int n = a->cores.size();
+
+    if (a->graph.empty()) {
+	// without a communication graph every other core of the
+	// application is as likely
+	int k = randInt(0, n - 2);
+	if (a->cores[k] == local_id)
+	    k = n - 1;
+	p.dst_id = a->cores[k];
+    } else {
+	// an edge leaving one of the tasks of the PE, in proportion to
+	// its volume. The data sent to a task of the same PE stays there.
+	int core = find(a->cores.begin(), a->cores.end(), local_id) -
+	    a->cores.begin();
+	double total = 0.0;
+	for (unsigned int i = 0; i < a->graph.size(); i++)
+	    if (a->graph[i].src % n == core)
+		total += a->graph[i].volume;
+
+	double rnd = rand() / (double) RAND_MAX * total;
+	for (unsigned int i = 0; i < a->graph.size(); i++) {
+	    if (a->graph[i].src % n != core || a->graph[i].volume == 0.0)
+		continue;
+	    rnd -= a->graph[i].volume;
+	    if (rnd <= 0.0) {
+		int dst = a->task_core(a->graph[i].dst);
+		if (dst != local_id)
+		    p.dst_id = dst;
+		break;
+	    }
+	}
+    }
+
+    p.timestamp = sc_time_stamp().to_double() / 1000;
+    p.size = p.flit_left = getRandomSize();
+
+    return p;
+}
+
 NoximPacket NoximProcessingElement::trafficTranspose1()
 {
     NoximPacket p;
     p.src_id = local_id;
     NoximCoord src, dst;
 
-    // Transpose 1 destination distribution
-    src.x = id2Coord(p.src_id).x;
-    src.y = id2Coord(p.src_id).y;
+    // Transpose 1 destination distribution, among the routers: the
+    // packet goes to the PE with the same index at the destination
+    src.x = id2Coord(peRouterId(p.src_id)).x;
+    src.y = id2Coord(peRouterId(p.src_id)).y;
     dst.x = NoximGlobalParams::mesh_dim_x - 1 - src.y;
     dst.y = NoximGlobalParams::mesh_dim_y - 1 - src.x;
     fixRanges(src, dst);
-    p.dst_id = coord2Id(dst);
+    p.dst_id = coord2Id(dst) * NoximGlobalParams::concentration +
+	peIndex(p.src_id);
 
     p.timestamp = sc_time_stamp().to_double() / 1000;
     p.size = p.flit_left = getRandomSize();
@@ -286,13 +361,14 @@ NoximPacket NoximProcessingElement::trafficTranspose2()
     p.src_id = local_id;
     NoximCoord src, dst;
 
-    // Transpose 2 destination distribution
-    src.x = id2Coord(p.src_id).x;
-    src.y = id2Coord(p.src_id).y;
+    // Transpose 2 destination distribution, among the routers
+    src.x = id2Coord(peRouterId(p.src_id)).x;
+    src.y = id2Coord(peRouterId(p.src_id)).y;
     dst.x = src.y;
     dst.y = src.x;
     fixRanges(src, dst);
-    p.dst_id = coord2Id(dst);
+    p.dst_id = coord2Id(dst) * NoximGlobalParams::concentration +
+	peIndex(p.src_id);
 
     p.timestamp = sc_time_stamp().to_double() / 1000;
     p.size = p.flit_left = getRandomSize();
@@ -327,9 +403,7 @@ NoximPacket NoximProcessingElement::trafficBitReversal()
 
     int nbits =
 	(int)
-	log2ceil((double)
-		 (NoximGlobalParams::mesh_dim_x *
-		  NoximGlobalParams::mesh_dim_y));
+	log2ceil((double) peCount());
     int dnode = 0;
     for (int i = 0; i < nbits; i++)
 	setBit(dnode, i, getBit(local_id, nbits - i - 1));
@@ -349,9 +423,7 @@ NoximPacket NoximProcessingElement::trafficShuffle()
 
     int nbits =
 	(int)
-	log2ceil((double)
-		 (NoximGlobalParams::mesh_dim_x *
-		  NoximGlobalParams::mesh_dim_y));
+	log2ceil((double) peCount());
     int dnode = 0;
     for (int i = 0; i < nbits - 1; i++)
 	setBit(dnode, i + 1, getBit(local_id, i));
@@ -372,9 +444,7 @@ NoximPacket NoximProcessingElement::trafficButterfly()
 
     int nbits =
 	(int)
-	log2ceil((double)
-		 (NoximGlobalParams::mesh_dim_x *
-		  NoximGlobalParams::mesh_dim_y));
+	log2ceil((double) peCount());
     int dnode = 0;
     for (int i = 1; i < nbits - 1; i++)
 	setBit(dnode, i, getBit(local_id, i));
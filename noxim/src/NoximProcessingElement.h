@@ -15,9 +15,12 @@
 #include <systemc.h>
 #include "NoximMain.h"
 #include "NoximGlobalTrafficTable.h"
+#include "NoximApp.h"
 
 using namespace std;
 
+class NoximMapper;
+
 SC_MODULE(NoximProcessingElement)
 {
 
@@ -25,11 +28,11 @@ SC_MODULE(NoximProcessingElement)
     sc_in_clk clock;		// The input clock for the PE
     sc_in < bool > reset;	// The reset signal for the PE
 
-    sc_in < NoximFlit > flit_rx;	// The input channel
+    sc_in < NoximFlitBundle > flit_rx;	// The input channel
     sc_in < bool > req_rx;	// The request associated with the input channel
     sc_out < bool > ack_rx;	// The outgoing ack signal associated with the input channel
 
-    sc_out < NoximFlit > flit_tx;	// The output channel
+    sc_out < NoximFlitBundle > flit_tx;	// The output channel
     sc_out < bool > req_tx;	// The request associated with the output channel
     sc_in < bool > ack_tx;	// The outgoing ack signal associated with the output channel
 
@@ -42,36 +45,28 @@ SC_MODULE(NoximProcessingElement)
     queue < NoximPacket > packet_queue;	// Local queue of packets
     bool transmittedAtPreviousCycle;	// Used for distributions with memory
 
-    // Applications
-    //APPLICATION app;
-    int arrival; // arrival is the arrival time and the id of the application
-    int end; // end is the time when application ends
-    bool occupied;
-    void exProcess();
-    void mapTask(int s, int e);
-    void clearTask();
-    
-    // Variables for lifetime reliability
-    double budget; // lifetime budget
-    double price;  // price, the inverse of lifetime budget
-    bool enabled;  // if the lifetime budget is positive
-
     // Functions
     void rxProcess();		// The receiving process
     void txProcess();		// The transmitting process
     bool canShot(NoximPacket & packet);	// True when the packet must be shot
     NoximFlit nextFlit();	// Take the next flit of the current packet
+    void flushQueue();		// Drops the queued packets not yet started
     NoximPacket trafficRandom();	// Random destination distribution
     NoximPacket trafficTranspose1();	// Transpose 1 destination distribution
     NoximPacket trafficTranspose2();	// Transpose 2 destination distribution
     NoximPacket trafficBitReversal();	// Bit-reversal destination distribution
     NoximPacket trafficShuffle();	// Shuffle destination distribution
     NoximPacket trafficButterfly();	// Butterfly destination distribution
+    NoximPacket trafficApplication();	// Among the cores of the application
+
+    const APPLICATION *mappedApplication();	// Running on the PE, NULL if idle
+    double applicationRate();	// Share of the cycles spent communicating
 
     void setUseLowVoltagePath(NoximPacket& packet);
 
     NoximGlobalTrafficTable *traffic_table;	// Reference to the Global traffic Table
     bool never_transmit;	// true if the PE does not transmit any packet 
+    NoximMapper *mapper;	// Mapping that drives the application traffic
 
     void fixRanges(const NoximCoord, NoximCoord &);	// Fix the ranges of the destination
     int randInt(int min, int max);	// Extracts a random integer number between min and max
@@ -89,10 +84,6 @@ SC_MODULE(NoximProcessingElement)
 	SC_METHOD(txProcess);
 	sensitive << reset;
 	sensitive << clock.pos();
-
-    SC_METHOD(exProcess);
-    sensitive << reset;
-    sensitive << clock.pos();
     }
 
 };
@@ -12,22 +12,28 @@
 
 NoximReservationTable::NoximReservationTable()
 {
-    clear();
+    configure(DIRECTIONS + 1);
+}
+
+void NoximReservationTable::configure(const int _n_ports)
+{
+    n_ports = _n_ports;
+    rtable.assign(n_ports, NOT_RESERVED);
 }
 
 void NoximReservationTable::clear()
 {
-    rtable.resize(DIRECTIONS + 1);
+    rtable.resize(n_ports);
 
     // note that NOT_VALID entries should remain untouched
-    for (int i = 0; i < DIRECTIONS + 1; i++)
+    for (int i = 0; i < n_ports; i++)
 	if (rtable[i] != NOT_VALID)
 	    rtable[i] = NOT_RESERVED;
 }
 
 bool NoximReservationTable::isAvailable(const int port_out) const
 {
-    assert(port_out >= 0 && port_out < DIRECTIONS + 1);
+    assert(port_out >= 0 && port_out < n_ports);
 
     return ((rtable[port_out] == NOT_RESERVED));
 }
@@ -49,18 +55,18 @@ void NoximReservationTable::reserve(const int port_in, const int port_out)
 
 void NoximReservationTable::release(const int port_out)
 {
-    assert(port_out >= 0 && port_out < DIRECTIONS + 1);
+    assert(port_out >= 0 && port_out < n_ports);
     // there is a valid reservation on port_out
-    assert(rtable[port_out] >= 0 && rtable[port_out] < DIRECTIONS + 1);
+    assert(rtable[port_out] >= 0 && rtable[port_out] < n_ports);
 
     rtable[port_out] = NOT_RESERVED;
 }
 
 int NoximReservationTable::getOutputPort(const int port_in) const
 {
-    assert(port_in >= 0 && port_in < DIRECTIONS + 1);
+    assert(port_in >= 0 && port_in < n_ports);
 
-    for (int i = 0; i < DIRECTIONS + 1; i++)
+    for (int i = 0; i < n_ports; i++)
 	if (rtable[i] == port_in)
 	    return i;		// port_in reserved outport i
 
@@ -68,6 +74,13 @@ int NoximReservationTable::getOutputPort(const int port_in) const
     return NOT_RESERVED;
 }
 
+int NoximReservationTable::getInputPort(const int port_out) const
+{
+    assert(port_out >= 0 && port_out < n_ports);
+
+    return rtable[port_out];
+}
+
 // makes port_out no longer available for reservation/release
 void NoximReservationTable::invalidate(const int port_out)
 {
@@ -20,6 +20,10 @@ class NoximReservationTable {
 
     NoximReservationTable();
 
+    // Sets the number of ports (physical ports times virtual channels)
+    // and clears every reservation
+    void configure(const int _n_ports);
+
     // Clear reservation table
     void clear();
 
@@ -36,11 +40,15 @@ class NoximReservationTable {
     // Returns the output port connected to port_in.
     int getOutputPort(const int port_in) const;
 
+    // Returns the input port holding port_out, NOT_RESERVED or NOT_VALID
+    int getInputPort(const int port_out) const;
+
     // Makes output port no longer available for reservation/release
     void invalidate(const int port_out);
 
   private:
 
+     int n_ports;
      vector < int >rtable;	// reservation vector: rtable[i] gives the input
     // port whose output port 'i' is connected to
 };
@@ -14,45 +14,57 @@ void NoximRouter::rxProcess()
 {
     if (reset.read()) {
 	// Clear outputs and indexes of receiving protocol
-	for (int i = 0; i < DIRECTIONS + 1; i++) {
+	for (int i = 0; i < ports(); i++) {
 	    ack_rx[i].write(0);
 	    current_level_rx[i] = 0;
 	}
 	reservation_table.clear();
 	routed_flits = 0;
+	bypassed_flits = 0;
+	dropped_flits = 0;
 	local_drained = 0;
+	for (int i = 0; i < MAX_ROUTER_PORTS; i++)
+	    for (int vc = 0; vc < MAX_VIRTUAL_CHANNELS; vc++)
+		draining[i][vc] = false;
     } else {
 	// For each channel decide if a new flit can be accepted
 	//
 	// This process simply sees a flow of incoming flits. All arbitration
 	// and wormhole related issues are addressed in the txProcess()
 
-	for (int i = 0; i < DIRECTIONS + 1; i++) {
-	    // To accept a new flit, the following conditions must match:
+	for (int i = 0; i < ports(); i++) {
+	    // To accept new flits, the following conditions must match:
 	    //
 	    // 1) there is an incoming request
-	    // 2) there is a free slot in the input buffer of direction i
+	    // 2) there are enough free slots in the input buffers of
+	    //    direction i for all the flits carried by the link
 
 	    if ((req_rx[i].read() == 1 - current_level_rx[i])
-		&& !buffer[i].IsFull()) {
-		NoximFlit received_flit = flit_rx[i].read();
+		&& canAccept(i, flit_rx[i].read())) {
+		NoximFlitBundle received = flit_rx[i].read();
 
-		if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) {
-		    cout << sc_time_stamp().to_double() /
-			1000 << ": Router[" << local_id << "], Input[" << i
-			<< "], Received flit: " << received_flit << endl;
+		for (int k = 0; k < received.size; k++) {
+		    NoximFlit received_flit = received.flit[k];
+		    int vc = received_flit.vc_id;
+
+		    if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) {
+			cout << sc_time_stamp().to_double() /
+			    1000 << ": Router[" << local_id << "], Input[" << i
+			    << "], Received flit: " << received_flit << endl;
+		    }
+		    // Store the incoming flit in the circular buffer
+		    buffer[i][vc].Push(received_flit);
+		    arrival_time[i][vc].push(sc_time_stamp().to_double() / 1000);
+
+		    // Incoming flit
+		    stats.power.Buffering();
+
+		    if (peRouterId(received_flit.src_id) == local_id)
+		      stats.power.EndToEnd();
 		}
-		// Store the incoming flit in the circular buffer
-		buffer[i].Push(received_flit);
 
 		// Negate the old value for Alternating Bit Protocol (ABP)
 		current_level_rx[i] = 1 - current_level_rx[i];
-
-		// Incoming flit
-		stats.power.Buffering();
-
-		if (received_flit.src_id == local_id)
-		  stats.power.EndToEnd();
 	    }
 	    ack_rx[i].write(current_level_rx[i]);
 	}
@@ -65,127 +77,805 @@ void NoximRouter::txProcess()
   if (reset.read()) 
     {
       // Clear outputs and indexes of transmitting protocol
-      for (int i = 0; i < DIRECTIONS + 1; i++) 
+      for (int i = 0; i < ports(); i++) 
 	{
 	  req_tx[i].write(0);
 	  current_level_tx[i] = 0;
+	  vc_priority[i] = 0;
+	  for (int vc = 0; vc < MAX_VIRTUAL_CHANNELS; vc++)
+	    {
+	      grant_time[i][vc] = 0.0;
+	      while (!arrival_time[i][vc].empty())
+		arrival_time[i][vc].pop();
+	    }
+	  while (!output_stages[i].empty())
+	    output_stages[i].pop();
+	  link_free_time[i] = 0.0;
+	}
+      for (int i = 0; i < DIRECTIONS; i++) 
+	{
+	  drained_flits[i] = NoximCreditCount();
+	  sent_flits[i] = NoximCreditCount();
+	  bypass_hops[i] = 0;
+	  bypass_request[i] = NOT_VALID;
+	  bypass_answered[i] = false;
+	  bypass_flits[i] = NoximFlitBundle();
+	  bypassing[i] = false;
 	}
     } 
   else 
     {
-      // 1st phase: Reservation
-      for (int j = 0; j < DIRECTIONS + 1; j++) 
+      // Flits leaving each output port in this cycle
+      NoximFlitBundle bundle[MAX_ROUTER_PORTS];
+
+      if (NoximGlobalParams::smart_hpc_max > 1)
+	bypassPhase();
+
+      drainingPhase();
+
+      // Flits that completed the switch and link traversal stages are
+      // the first to use the links
+      linkTraversalPhase(bundle);
+
+      reservationPhase();
+      forwardingPhase(bundle);
+
+      // With a crossbar speedup S the switch is traversed S times per
+      // link cycle: a packet whose tail has just left can release its
+      // output to another input within the same cycle. Routing and
+      // priorities are only updated once per cycle.
+      for (int s = 1; s < NoximGlobalParams::crossbar_speedup; s++)
 	{
-	  int i = (start_from_port + j) % (DIRECTIONS + 1);
+	  reallocationPhase();
+	  forwardingPhase(bundle);
+	}
+      switch_allocator.endCycle();
 
-	  if (!buffer[i].IsEmpty()) 
-	    {
-	      NoximFlit flit = buffer[i].Front();
+      double now = sc_time_stamp().to_double() / 1000;
 
-	      if (flit.flit_type == FLIT_TYPE_HEAD) 
+      for (int o = 0; o < ports(); o++) 
+	{
+	  if (o < DIRECTIONS)
+	    bypass_flits[o] = NoximFlitBundle();
+
+	  if (bundle[o].size > 0) 
+	    {
+	      if (o < DIRECTIONS && bypass_hops[o] > 0)
 		{
-		  // prepare data for routing
-		  NoximRouteData route_data;
-		  route_data.current_id = local_id;
-		  route_data.src_id = flit.src_id;
-		  route_data.dst_id = flit.dst_id;
-		  route_data.dir_in = i;
+		  // the side network carries them at the falling edge, the
+		  // routers in between are released by the tail
+		  bypass_flits[o] = bundle[o];
+		  if (bundle[o].flit[bundle[o].size - 1].flit_type ==
+		      FLIT_TYPE_TAIL)
+		    bypass_hops[o] = 0;
+		}
+	      else
+		{
+		  flit_tx[o].write(bundle[o]);
+		  current_level_tx[o] = 1 - current_level_tx[o];
+		  req_tx[o].write(current_level_tx[o]);
+		}
 
+	      // Without pipeline registers a multi-cycle link carries a
+	      // single transfer at a time, slow inter-chip links accept a
+	      // transfer every few cycles
+	      link_free_time[o] = now + link_period[o];
+	    }
+	}
+    }
+  stats.power.Leakage();
+}
+
+int NoximRouter::ports() const
+{
+  return network_ports + NoximGlobalParams::concentration;
+}
+
+bool NoximRouter::isLocal(const int port) const
+{
+  return port >= DIRECTION_LOCAL &&
+    port < DIRECTION_LOCAL + NoximGlobalParams::concentration;
+}
+
+int NoximRouter::expressPort(const int direction) const
+{
+  return DIRECTIONS + NoximGlobalParams::concentration + direction;
+}
+
+int NoximRouter::routingStages() const
+{
+  // Lookahead routing is a timing-only model: the port is still
+  // computed here, but as if the upstream router had done it, off the
+  // critical path
+  if (NoximGlobalParams::lookahead_routing)
+    return 0;
+
+  return NoximGlobalParams::rc_stages;
+}
+
+int NoximRouter::outputStages() const
+{
+  return NoximGlobalParams::st_stages + NoximGlobalParams::lt_stages;
+}
+
+int NoximRouter::outputDelay(const int port_out) const
+{
+  return outputStages() + link_delay[port_out];
+}
+
+int NoximRouter::virtualPort(const int port, const int vc) const
+{
+  return port * NoximGlobalParams::virtual_channels + vc;
+}
+
+bool NoximRouter::outputAvailable(const int port_out) const
+{
+  for (int vc = 0; vc < NoximGlobalParams::virtual_channels; vc++)
+    if (reservation_table.isAvailable(virtualPort(port_out, vc)))
+      return true;
+
+  return false;
+}
+
+bool NoximRouter::crossesDateline(const int dir_out) const
+{
+  if (NoximGlobalParams::topology == TOPOLOGY_MESH ||
+      NoximGlobalParams::topology == TOPOLOGY_GRAPH)
+    return false;
+
+  // the dateline of each ring is its wraparound link
+  NoximCoord position = id2Coord(local_id);
+
+  switch (dir_out) {
+  case DIRECTION_NORTH:
+    return position.y == 0;
+  case DIRECTION_SOUTH:
+    return position.y == NoximGlobalParams::mesh_dim_y - 1;
+  case DIRECTION_WEST:
+    return position.x == 0;
+  case DIRECTION_EAST:
+    return position.x == NoximGlobalParams::mesh_dim_x - 1;
+  }
+
+  return false;
+}
+
+int NoximRouter::outputVirtualChannel(const int dir_in, const int vc_in,
+				      const int dir_out) const
+{
+  if (NoximGlobalParams::virtual_channels == 1 || isLocal(dir_out))
+    return 0;
+
+  // In a multi-chip mesh a packet moves to the next class at every
+  // chip it enters. Within a class it only follows XY routes inside
+  // a single chip, so there are no cycles.
+  if (NoximGlobalParams::chips_x * NoximGlobalParams::chips_y > 1)
+    {
+      int vc = isLocal(dir_in) ? 0 : vc_in;
+      if (crossesChip(dir_out))
+	vc++;
+      return vc;
+    }
+
+  // A packet entering a ring starts on the low class and moves to the
+  // high class once it crosses the dateline of that ring. The channel
+  // dependencies of each class are then acyclic.
+  bool horizontal_in = (dir_in == DIRECTION_EAST || dir_in == DIRECTION_WEST);
+  bool horizontal_out = (dir_out == DIRECTION_EAST || dir_out == DIRECTION_WEST);
+
+  int vc = 0;
+  if (!isLocal(dir_in) && horizontal_in == horizontal_out)
+    vc = vc_in;
+
+  if (crossesDateline(dir_out))
+    vc = 1;
+
+  return vc;
+}
+
+bool NoximRouter::crossesChip(const int dir_out) const
+{
+  if (NoximGlobalParams::chips_x * NoximGlobalParams::chips_y == 1 ||
+      isLocal(dir_out))
+    return false;
+
+  int neighbor = getNeighborId(local_id, dir_out);
+
+  return neighbor != NOT_VALID && chipId(neighbor) != chipId(local_id);
+}
+
+bool NoximRouter::hasCredit(const int port_out, const int vc) const
+{
+  // with a single channel the link handshake is enough: the receiver
+  // simply does not accept flits it cannot store
+  if (NoximGlobalParams::virtual_channels == 1 || isLocal(port_out))
+    return true;
+
+  unsigned long in_flight = sent_flits[port_out].drained[vc] -
+    credits_neighbor[port_out].read().drained[vc];
+
+  return in_flight < (unsigned long) NoximGlobalParams::buffer_depth;
+}
+
+bool NoximRouter::canAccept(const int i, const NoximFlitBundle & bundle) const
+{
+  int needed[MAX_VIRTUAL_CHANNELS];
+  for (int vc = 0; vc < MAX_VIRTUAL_CHANNELS; vc++)
+    needed[vc] = 0;
+
+  for (int k = 0; k < bundle.size; k++)
+    needed[bundle.flit[k].vc_id]++;
+
+  for (int vc = 0; vc < NoximGlobalParams::virtual_channels; vc++)
+    if ((int) buffer[i][vc].getCurrentFreeSlots() < needed[vc])
+      return false;
+
+  return true;
+}
+
+void NoximRouter::reservationPhase()
+{
+  double now = sc_time_stamp().to_double() / 1000;
+
+  switch_allocator.clearRequests();
+  int n_inputs = ports() * NoximGlobalParams::virtual_channels;
+  for (int j = 0; j < n_inputs; j++) 
+    {
+      int vi = (switch_allocator.firstInput() + j) % n_inputs;
+      int i = vi / NoximGlobalParams::virtual_channels;
+      int vc = vi % NoximGlobalParams::virtual_channels;
+
+      if (!buffer[i][vc].IsEmpty()) 
+	{
+	  NoximFlit flit = buffer[i][vc].Front();
+
+	  // head flits still in the route computation stage
+	  if (flit.flit_type == FLIT_TYPE_HEAD &&
+	      now < arrival_time[i][vc].front() + routingStages())
+	    continue;
+
+	  if (flit.flit_type == FLIT_TYPE_HEAD) 
+	    {
+	      // prepare data for routing
+	      NoximRouteData route_data;
+	      route_data.current_id = local_id;
+	      route_data.src_id = flit.src_id;
+	      route_data.dst_id = flit.dst_id;
+	      route_data.dir_in = i;
+
+	      if (switch_allocator.acceptsMultipleRequests())
+		{
+		  // inputs that already own an output are not matched again
+		  if (reservation_table.getOutputPort(vi) != NOT_RESERVED)
+		    continue;
+
+		  // the allocator chooses among all the admissible outputs
+		  vector < int >candidates = routeCandidates(route_data);
+		  for (unsigned int k = 0; k < candidates.size(); k++)
+		    switch_allocator.request(vi, virtualPort(candidates[k],
+		      outputVirtualChannel(i, vc, candidates[k])));
+		}
+	      else
+		{
+		  // reserved at once, so that the next inputs route
+		  // knowing this reservation
 		  int o = route(route_data);
+		  switch_allocator.request(vi, virtualPort(o,
+		    outputVirtualChannel(i, vc, o)));
+		  switch_allocator.serve(reservation_table, vi);
+		}
 
-		  stats.power.Arbitration();
-
-		  if (reservation_table.isAvailable(o)) 
-		    {
-		      stats.power.Crossbar();
-		      reservation_table.reserve(i, o);
-		      if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) 
-			{
-			  cout << sc_time_stamp().to_double() / 1000
-			       << ": Router[" << local_id
-			       << "], Input[" << i << "] (" << buffer[i].
-			    Size() << " flits)" << ", reserved Output["
-			       << o << "], flit: " << flit << endl;
-			}
-		    }
+	      stats.power.Arbitration();
+	    }
+	}
+    }
+
+  vector < int >grants;
+  switch_allocator.allocate(reservation_table, grants);
+  grantPhase(grants);
+}
+
+void NoximRouter::reallocationPhase()
+{
+  // the heads routed in this cycle compete again for the outputs
+  // released by the previous traversals
+  vector < int >grants;
+  if (switch_allocator.reallocate(reservation_table, grants) > 0)
+    grantPhase(grants);
+}
+
+void NoximRouter::grantPhase(const vector < int >&grants)
+{
+  double now = sc_time_stamp().to_double() / 1000;
+
+  for (int i = 0; i < ports(); i++) 
+    for (int vc = 0; vc < NoximGlobalParams::virtual_channels; vc++) 
+      {
+	int vi = virtualPort(i, vc);
+	if (grants[vi] != NOT_VALID) 
+	  {
+	    grant_time[i][vc] = now;
+	    stats.power.Crossbar();
+	    if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) 
+	      {
+		cout << sc_time_stamp().to_double() / 1000
+		     << ": Router[" << local_id
+		     << "], Input[" << i << "] (" << buffer[i][vc].
+		  Size() << " flits)" << ", reserved Output["
+		     << grants[vi] / NoximGlobalParams::virtual_channels
+		     << "], flit: " << buffer[i][vc].Front() << endl;
+	      }
+	  }
+      }
+}
+
+void NoximRouter::drainingPhase()
+{
+  for (int i = 0; i < ports(); i++) 
+    for (int vc = 0; vc < NoximGlobalParams::virtual_channels; vc++) 
+      while (draining[i][vc] && !buffer[i][vc].IsEmpty())
+	{
+	  NoximFlit flit = buffer[i][vc].Pop();
+	  arrival_time[i][vc].pop();
+	  dropped_flits++;
+
+	  // the upstream router gets its credits back as usual
+	  if (i < DIRECTIONS)
+	    drained_flits[i].drained[vc]++;
+
+	  if (flit.flit_type == FLIT_TYPE_TAIL)
+	    draining[i][vc] = false;
+	}
+}
+
+vector <int> NoximRouter::waitedOutputs(const int i, const int vc)
+{
+  vector <int> outputs;
+
+  // a packet being drained waits for nothing
+  if (buffer[i][vc].IsEmpty() || draining[i][vc])
+    return outputs;
+
+  int vo = reservation_table.getOutputPort(virtualPort(i, vc));
+  if (vo != NOT_RESERVED)
+    {
+      outputs.push_back(vo);
+      return outputs;
+    }
+
+  NoximFlit flit = buffer[i][vc].Front();
+  if (flit.flit_type != FLIT_TYPE_HEAD)
+    return outputs;
+
+  // same candidates as routeCandidates(), without charging energy
+  vector <int> candidates;
+  if (peRouterId(flit.dst_id) == local_id)
+    candidates.push_back(DIRECTION_LOCAL + peIndex(flit.dst_id));
+  else
+    {
+      NoximRouteData route_data;
+      route_data.current_id = local_id;
+      route_data.src_id = flit.src_id;
+      route_data.dst_id = flit.dst_id;
+      route_data.dir_in = i;
+      candidates = routingFunction(route_data);
+    }
+
+  for (unsigned int k = 0; k < candidates.size(); k++)
+    outputs.push_back(virtualPort(candidates[k],
+				  outputVirtualChannel(i, vc, candidates[k])));
+
+  return outputs;
+}
+
+void NoximRouter::drainPacket(const int i, const int vc)
+{
+  draining[i][vc] = true;
+}
+
+vector <int> NoximRouter::zeroLoadOutputs(const NoximRouteData & route_data)
+{
+  if (peRouterId(route_data.dst_id) == local_id)
+    return vector <int> (1, DIRECTION_LOCAL + peIndex(route_data.dst_id));
+
+  // DyAD keeps to its deterministic route until a neighbor congests
+  if (NoximGlobalParams::routing_algorithm == ROUTING_DYAD)
+    {
+      vector <int> directions =
+	routingOddEven(id2Coord(route_data.current_id),
+		       id2Coord(peRouterId(route_data.src_id)),
+		       id2Coord(peRouterId(route_data.dst_id)));
+      directions.resize(1);
+      return directions;
+    }
+
+  return routingFunction(route_data);
+}
+
+int NoximRouter::zeroLoadDelay(const int port_out) const
+{
+  // a delivered flit is accounted for as soon as it leaves the output
+  // stages, the next router stores it one cycle after the link
+  int delay = routingStages() + NoximGlobalParams::sa_stages - 1 +
+    outputDelay(port_out);
+
+  return isLocal(port_out) ? delay : delay + 1;
+}
+
+double NoximRouter::outputCapacity(const int port_out) const
+{
+  // the alternating bit handshake takes two cycles per transfer
+  return (double) NoximGlobalParams::link_width / max(2, link_period[port_out]);
+}
+
+void NoximRouter::forwardingPhase(NoximFlitBundle bundle[])
+{
+  double now = sc_time_stamp().to_double() / 1000;
+  int n_vcs = NoximGlobalParams::virtual_channels;
+
+  // Flits entering the switch traversal stage of each output
+  int traversing[MAX_ROUTER_PORTS];
+  for (int o = 0; o < ports(); o++)
+    traversing[o] = 0;
+
+  for (int i = 0; i < ports(); i++) 
+    {
+      // Each input feeds the switch from one of its virtual channels,
+      // chosen in round-robin order among the ones that can proceed
+      for (int k = 0; k < n_vcs; k++) 
+	{
+	  int vc = (vc_priority[i] + k) % n_vcs;
+	  int vi = virtualPort(i, vc);
+	  int moved = 0;
+
+	  // The crossbar is as wide as the links, so an input can move as
+	  // many flits as the output link still accepts in this cycle
+	  while (!buffer[i][vc].IsEmpty()) 
+	    {
+	      NoximFlit flit = buffer[i][vc].Front();
+
+	      int vo = reservation_table.getOutputPort(vi);
+	      if (vo == NOT_RESERVED)
+		break;
+
+	      int o = vo / n_vcs;
+	      int out_vc = vo % n_vcs;
+
+	      // the head leaves the input after the allocation stages
+	      if (flit.flit_type == FLIT_TYPE_HEAD &&
+		  now < grant_time[i][vc] + NoximGlobalParams::sa_stages - 1)
+		break;
+
+	      if (outputDelay(o) == 0)
+		{
+		  // the flit goes straight onto the link
+		  if (current_level_tx[o] != ack_tx[o].read() ||
+		      bundle[o].size == NoximGlobalParams::link_width ||
+		      bundle[o].size == bypassSlots(o) ||
+		      now < link_free_time[o])
+		    break;
+		}
+	      else
+		{
+		  // the flit needs a free slot in the stages of the output
+		  if (traversing[o] == NoximGlobalParams::link_width ||
+		      (int) output_stages[o].size() ==
+		      outputDelay(o) * NoximGlobalParams::link_width)
+		    break;
+		}
+
+	      if (!hasCredit(o, out_vc))
+		break;
+
+	      if (outputDelay(o) == 0 && awaitsBypass(o, flit))
+		break;
+
+	      if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) 
+		{
+		  cout << sc_time_stamp().to_double() / 1000
+		       << ": Router[" << local_id
+		       << "], Input[" << i <<
+		    "] forward to Output[" << o << "], flit: "
+		       << flit << endl;
+		}
+
+	      buffer[i][vc].Pop();
+	      arrival_time[i][vc].pop();
+	      moved++;
+
+	      // credits only flow on the mesh links
+	      if (i < DIRECTIONS)
+		drained_flits[i].drained[vc]++;
+	      if (o < DIRECTIONS)
+		sent_flits[o].drained[out_vc]++;
+
+	      flit.vc_id = out_vc;
+
+	      stats.power.CrossbarTraversal();
+
+	      if (outputDelay(o) == 0)
+		linkTraversal(i, o, flit, bundle[o]);
+	      else
+		{
+		  NoximStagedFlit staged;
+		  staged.flit = flit;
+		  staged.dir_in = i;
+		  staged.ready_time = now + outputDelay(o);
+		  output_stages[o].push(staged);
+		  traversing[o]++;
+		}
+
+	      // the next packet has to win the output again
+	      if (flit.flit_type == FLIT_TYPE_TAIL)
+		{
+		  reservation_table.release(vo);
+		  break;
 		}
 	    }
+
+	  if (moved > 0)
+	    {
+	      vc_priority[i] = (vc + 1) % n_vcs;
+	      break;
+	    }
+	}
+    }
+}
+
+void NoximRouter::linkTraversalPhase(NoximFlitBundle bundle[])
+{
+  double now = sc_time_stamp().to_double() / 1000;
+
+  for (int o = 0; o < ports(); o++) 
+    {
+      if (current_level_tx[o] != ack_tx[o].read() ||
+	  now < link_free_time[o])
+	continue;
+
+      while (!output_stages[o].empty() &&
+	     output_stages[o].front().ready_time <= now &&
+	     bundle[o].size < NoximGlobalParams::link_width &&
+	     bundle[o].size < bypassSlots(o))
+	{
+	  if (awaitsBypass(o, output_stages[o].front().flit))
+	    break;
+
+	  NoximStagedFlit staged = output_stages[o].front();
+	  output_stages[o].pop();
+
+	  linkTraversal(staged.dir_in, o, staged.flit, bundle[o]);
+	}
+    }
+}
+
+void NoximRouter::linkTraversal(const int i, const int o,
+				const NoximFlit & flit,
+				NoximFlitBundle & bundle)
+{
+  bundle.flit[bundle.size] = flit;
+  if (!isLocal(o))
+    bundle.flit[bundle.size].hop_no++;
+  bundle.size++;
+
+  if (NoximGlobalParams::low_power_link_strategy)
+    {
+      if (flit.flit_type == FLIT_TYPE_HEAD || 
+	  flit.use_low_voltage_path == false)
+	stats.power.Link(false, link_length[o]);
+      else
+	stats.power.Link(true, link_length[o]);
+    }
+  else
+    stats.power.Link(false, link_length[o]);
+
+  // the flit is latched by every register of a pipelined link
+  if (NoximGlobalParams::link_pipelining)
+    stats.power.LinkRegisters(link_delay[o]);
+
+  if (peRouterId(flit.dst_id) == local_id)
+    stats.power.EndToEnd();
+
+  // Update stats
+  if (isLocal(o)) 
+    {
+      stats.receivedFlit(sc_time_stamp().
+			 to_double() / 1000, flit);
+      if (NoximGlobalParams::
+	  max_volume_to_be_drained) 
+	{
+	  if (drained_volume >=
+	      NoximGlobalParams::
+	      max_volume_to_be_drained)
+	    sc_stop();
+	  else 
+	    {
+	      drained_volume++;
+	      local_drained++;
+	    }
 	}
-      start_from_port++;
+    } 
+  else if (!isLocal(i)) 
+    {
+      // Increment routed flits counter
+      routed_flits++;
+    }
+}
+
+bool NoximRouter::goesStraight(const int id, const int o,
+			       const int dst) const
+{
+  // with XY routing the packet neither stops nor turns in router id
+  NoximCoord position = id2Coord(id);
+  NoximCoord destination = id2Coord(dst);
 
-      // 2nd phase: Forwarding
-      for (int i = 0; i < DIRECTIONS + 1; i++) 
+  if (o == DIRECTION_EAST || o == DIRECTION_WEST)
+    return destination.x != position.x;
+
+  return destination.x == position.x && destination.y != position.y;
+}
+
+bool NoximRouter::canBypass(const int in, const int o, const int dst) const
+{
+  double now = sc_time_stamp().to_double() / 1000;
+
+  if (!goesStraight(local_id, o, dst))
+    return false;
+
+  // no other packet may be using the input, the output or the link
+  return buffer[in][0].IsEmpty() &&
+    reservation_table.getOutputPort(in) == NOT_RESERVED &&
+    reservation_table.isAvailable(o) &&
+    bypass_hops[o] == 0 &&
+    bypass_request[o] == NOT_VALID &&
+    output_stages[o].empty() &&
+    current_level_tx[o] == ack_tx[o].read() &&
+    now >= link_free_time[o];
+}
+
+bool NoximRouter::awaitsBypass(const int o, const NoximFlit & flit)
+{
+  if (NoximGlobalParams::smart_hpc_max == 1 || o >= DIRECTIONS ||
+      flit.flit_type != FLIT_TYPE_HEAD)
+    return false;
+
+  // once the answer has come the head goes, through the bypass or not
+  if (bypass_answered[o])
+    {
+      bypass_answered[o] = false;
+      return false;
+    }
+
+  if (bypass_request[o] != NOT_VALID)
+    return true;
+
+  // a request is only worth it if the packet goes straight through the
+  // next router
+  int dst = peRouterId(flit.dst_id);
+  if (!goesStraight(getNeighborId(local_id, o), o, dst))
+    return false;
+
+  bypass_request[o] = dst;
+
+  return true;
+}
+
+int NoximRouter::bypassSlots(const int o) const
+{
+  if (o >= DIRECTIONS || bypass_hops[o] == 0)
+    return NoximGlobalParams::link_width;
+
+  // room left where the flits land, less the ones still on their way
+  return smart_in[o].read().landing_room - bypass_flits[o].size;
+}
+
+void NoximRouter::bypassPhase()
+{
+  double now = sc_time_stamp().to_double() / 1000;
+
+  for (int d = 0; d < DIRECTIONS; d++)
+    {
+      int in = reflexDirection(d);
+      NoximFlitBundle flits = smart_in[in].read().flits;
+
+      if (bypassing[d])
 	{
-	  if (!buffer[i].IsEmpty()) 
+	  // the flits went straight through, spending crossbar and link
+	  // energy only; the tail releases the router
+	  for (int k = 0; k < flits.size; k++)
 	    {
-	      NoximFlit flit = buffer[i].Front();
+	      stats.power.CrossbarTraversal();
+	      stats.power.Link(false, link_length[d]);
+	      bypassed_flits++;
 
-	      int o = reservation_table.getOutputPort(i);
-	      if (o != NOT_RESERVED) 
+	      if (flits.flit[k].flit_type == FLIT_TYPE_TAIL)
 		{
-		  if (current_level_tx[o] == ack_tx[o].read()) 
-		    {
-		      if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) 
-			{
-			  cout << sc_time_stamp().to_double() / 1000
-			       << ": Router[" << local_id
-			       << "], Input[" << i <<
-			    "] forward to Output[" << o << "], flit: "
-			       << flit << endl;
-			}
-
-		      flit_tx[o].write(flit);
-		      current_level_tx[o] = 1 - current_level_tx[o];
-		      req_tx[o].write(current_level_tx[o]);
-		      buffer[i].Pop();
-
-		      if (NoximGlobalParams::low_power_link_strategy)
-			{
-			  if (flit.flit_type == FLIT_TYPE_HEAD || 
-			      flit.use_low_voltage_path == false)
-			    stats.power.Link(false);
-			  else
-			    stats.power.Link(true);
-			}
-		      else
-			stats.power.Link(false);
-
-		      if (flit.dst_id == local_id)
-			stats.power.EndToEnd();
-
-		      if (flit.flit_type == FLIT_TYPE_TAIL)
-			reservation_table.release(o);
-
-		      // Update stats
-		      if (o == DIRECTION_LOCAL) 
-			{
-			  stats.receivedFlit(sc_time_stamp().
-					     to_double() / 1000, flit);
-			  if (NoximGlobalParams::
-			      max_volume_to_be_drained) 
-			    {
-			      if (drained_volume >=
-				  NoximGlobalParams::
-				  max_volume_to_be_drained)
-				sc_stop();
-			      else 
-				{
-				  drained_volume++;
-				  local_drained++;
-				}
-			    }
-			} 
-		      else if (i != DIRECTION_LOCAL) 
-			{
-			  // Increment routed flits counter
-			  routed_flits++;
-			}
-		    }
+		  reservation_table.release(d);
+		  bypassing[d] = false;
 		}
 	    }
 	}
-    }				// else
-  stats.power.Leakage();
+      else
+	{
+	  // the flits landed here, a cycle after leaving the requester
+	  for (int k = 0; k < flits.size; k++)
+	    {
+	      buffer[in][0].Push(flits.flit[k]);
+	      arrival_time[in][0].push(now);
+
+	      stats.power.Buffering();
+	    }
+	}
+
+      // a granted request holds the router until the tail goes through
+      if (bypass_granted[d])
+	{
+	  reservation_table.reserve(in, d);
+	  bypassing[d] = true;
+	}
+
+      // the requester learns how many routers its packet skips
+      if (bypass_request[d] != NOT_VALID)
+	{
+	  bypass_hops[d] = smart_in[d].read().landing_hops;
+	  bypass_request[d] = NOT_VALID;
+	  bypass_answered[d] = true;
+	}
+    }
+}
+
+void NoximRouter::smartProcess()
+{
+  // Evaluated again whenever a neighbor changes what it drives: a
+  // request goes as far as the idle routers let it and the answer comes
+  // back before the next rising edge, which latches the result
+  NoximSmartLink link[DIRECTIONS];
+
+  for (int d = 0; d < DIRECTIONS; d++)
+    {
+      int in = reflexDirection(d);
+      NoximSmartLink upstream = smart_in[in].read();
+      NoximSmartLink downstream = smart_in[d].read();
+
+      // requests and flits of the packets going towards d: the router
+      // in the way answers, and becomes a wire only if the flits can
+      // land beyond it
+      bool idle = upstream.request_dst != NOT_VALID &&
+	upstream.request_hops > 0 &&
+	canBypass(in, d, upstream.request_dst);
+      bypass_granted[d] = idle && downstream.landing_room > 0;
+
+      if (idle)
+	{
+	  link[d].request_dst = upstream.request_dst;
+	  link[d].request_hops = upstream.request_hops - 1;
+	}
+      else if (bypass_request[d] != NOT_VALID)
+	{
+	  link[d].request_dst = bypass_request[d];
+	  link[d].request_hops = NoximGlobalParams::smart_hpc_max - 1;
+	}
+
+      if (bypassing[d])
+	{
+	  link[d].flits = upstream.flits;
+	  for (int k = 0; k < link[d].flits.size; k++)
+	    link[d].flits.flit[k].hop_no++;
+	}
+      else
+	link[d].flits = bypass_flits[d];
+
+      // answers to the router these packets come from
+      if (bypassing[d] || bypass_granted[d])
+	{
+	  link[in].landing_room = downstream.landing_room;
+	  link[in].landing_hops = downstream.landing_hops + 1;
+	}
+      else
+	link[in].landing_room = buffer[in][0].getCurrentFreeSlots();
+    }
+
+  for (int d = 0; d < DIRECTIONS; d++)
+    smart_out[d].write(link[d]);
 }
 
 NoximNoP_data NoximRouter::getCurrentNoPData() const
@@ -196,7 +886,7 @@ NoximNoP_data NoximRouter::getCurrentNoPData() const
 	NoP_data.channel_status_neighbor[j].free_slots =
 	    free_slots_neighbor[j].read();
 	NoP_data.channel_status_neighbor[j].available =
-	    (reservation_table.isAvailable(j));
+	    outputAvailable(j);
     }
 
     NoP_data.sender_id = local_id;
@@ -207,16 +897,26 @@ NoximNoP_data NoximRouter::getCurrentNoPData() const
 void NoximRouter::bufferMonitor()
 {
     if (reset.read()) {
-	for (int i = 0; i < DIRECTIONS + 1; i++)
-	    free_slots[i].write(buffer[i].GetMaxBufferSize());
+	for (int i = 0; i < ports(); i++)
+	    free_slots[i].write(freeSlots(i));
+	for (int i = 0; i < DIRECTIONS; i++) {
+	    credits[i].write(NoximCreditCount());
+	    congestion_out[i].write(0.0);
+	}
     } else {
 
+	// tell upstream routers how many flits left each virtual channel
+	if (NoximGlobalParams::virtual_channels > 1)
+	    for (int i = 0; i < DIRECTIONS; i++)
+		credits[i].write(drained_flits[i]);
+
 	if (NoximGlobalParams::selection_strategy == SEL_BUFFER_LEVEL ||
-	    NoximGlobalParams::selection_strategy == SEL_NOP) {
+	    NoximGlobalParams::selection_strategy == SEL_NOP ||
+	    NoximGlobalParams::selection_strategy == SEL_RCA) {
 
 	    // update current input buffers level to neighbors
-	    for (int i = 0; i < DIRECTIONS + 1; i++)
-		free_slots[i].write(buffer[i].getCurrentFreeSlots());
+	    for (int i = 0; i < ports(); i++)
+		free_slots[i].write(freeSlots(i));
 
 	    // NoP selection: send neighbor info to each direction 'i'
 	    NoximNoP_data current_NoP_data = getCurrentNoPData();
@@ -224,19 +924,33 @@ void NoximRouter::bufferMonitor()
 	    for (int i = 0; i < DIRECTIONS; i++)
 		NoP_data_out[i].write(current_NoP_data);
 	}
+
+	// RCA selection: the estimate of the region in direction 'i' is
+	// handed upstream, i.e. to the neighbor on the opposite side
+	if (NoximGlobalParams::selection_strategy == SEL_RCA)
+	    for (int i = 0; i < DIRECTIONS; i++)
+		congestion_out[reflexDirection(i)].write(regionalCongestion(i));
     }
 }
 
 vector <
     int >NoximRouter::routingFunction(const NoximRouteData & route_data)
 {
+    // Routing works on the routers the source and destination PEs are
+    // attached to, all the local ports look the same
     NoximCoord position = id2Coord(route_data.current_id);
-    NoximCoord src_coord = id2Coord(route_data.src_id);
-    NoximCoord dst_coord = id2Coord(route_data.dst_id);
-    int dir_in = route_data.dir_in;
+    NoximCoord src_coord = id2Coord(peRouterId(route_data.src_id));
+    NoximCoord dst_coord = id2Coord(peRouterId(route_data.dst_id));
+    int dir_in = isLocal(route_data.dir_in) ? DIRECTION_LOCAL : route_data.dir_in;
 
     switch (NoximGlobalParams::routing_algorithm) {
     case ROUTING_XY:
+	if (NoximGlobalParams::topology != TOPOLOGY_MESH)
+	    return routingTorusXY(position, dst_coord);
+	if (NoximGlobalParams::chips_x * NoximGlobalParams::chips_y > 1)
+	    return routingChipXY(position, dst_coord);
+	if (NoximGlobalParams::express_span > 0)
+	    return routingExpressXY(position, dst_coord);
 	return routingXY(position, dst_coord);
 
     case ROUTING_WEST_FIRST:
@@ -272,14 +986,24 @@ int NoximRouter::route(const NoximRouteData & route_data)
 {
     stats.power.Routing();
 
-    if (route_data.dst_id == local_id)
-	return DIRECTION_LOCAL;
+    if (peRouterId(route_data.dst_id) == local_id)
+	return DIRECTION_LOCAL + peIndex(route_data.dst_id);
 
     vector < int >candidate_channels = routingFunction(route_data);
 
     return selectionFunction(candidate_channels, route_data);
 }
 
+vector < int >NoximRouter::routeCandidates(const NoximRouteData & route_data)
+{
+    stats.power.Routing();
+
+    if (peRouterId(route_data.dst_id) == local_id)
+	return vector < int >(1, DIRECTION_LOCAL + peIndex(route_data.dst_id));
+
+    return routingFunction(route_data);
+}
+
 void NoximRouter::NoP_report() const
 {
     NoximNoP_data NoP_tmp;
@@ -378,7 +1102,7 @@ int NoximRouter::selectionBufferLevel(const vector < int >&directions)
     int max_free_slots = 0;
     for (unsigned int i = 0; i < directions.size(); i++) {
 	int free_slots = free_slots_neighbor[directions[i]].read();
-	bool available = reservation_table.isAvailable(directions[i]);
+	bool available = outputAvailable(directions[i]);
 	if (available) {
 	    if (free_slots > max_free_slots) {
 		max_free_slots = free_slots;
@@ -438,6 +1162,49 @@ int NoximRouter::selectionRandom(const vector < int >&directions)
     return directions[rand() % directions.size()];
 }
 
+double NoximRouter::regionalCongestion(const int dir) const
+{
+    // Occupancy of the input buffers of the neighbor, as a fraction of
+    // their capacity (tied off ports look fully congested)
+    int free_slots = free_slots_neighbor[dir].read();
+    int capacity = NoximGlobalParams::buffer_depth *
+	NoximGlobalParams::virtual_channels;
+    double local = 1.0;
+    if (free_slots != NOT_VALID)
+	local = 1.0 - (double) free_slots / (double) capacity;
+
+    if (dir >= DIRECTIONS)
+	return local;
+
+    // Fold it into what the neighbor knows about the rest of the row
+    // or column, so farther routers weigh less and less
+    return RCA_LOCAL_WEIGHT * local +
+	(1.0 - RCA_LOCAL_WEIGHT) * congestion_in[dir].read();
+}
+
+int NoximRouter::selectionRCA(const vector < int >&directions)
+{
+    vector < int >best_dirs;
+    double min_congestion = 0.0;
+    for (unsigned int i = 0; i < directions.size(); i++) {
+	if (!outputAvailable(directions[i]))
+	    continue;
+
+	double congestion = regionalCongestion(directions[i]);
+	if (best_dirs.empty() || congestion < min_congestion) {
+	    min_congestion = congestion;
+	    best_dirs.clear();
+	    best_dirs.push_back(directions[i]);
+	} else if (congestion == min_congestion)
+	    best_dirs.push_back(directions[i]);
+    }
+
+    if (best_dirs.size())
+	return (best_dirs[rand() % best_dirs.size()]);
+    else
+	return (directions[rand() % directions.size()]);
+}
+
 int NoximRouter::selectionFunction(const vector < int >&directions,
 				   const NoximRouteData & route_data)
 {
@@ -454,6 +1221,8 @@ int NoximRouter::selectionFunction(const vector < int >&directions,
 	return selectionBufferLevel(directions);
     case SEL_NOP:
 	return selectionNoP(directions, route_data);
+    case SEL_RCA:
+	return selectionRCA(directions);
     default:
 	assert(false);
     }
@@ -478,6 +1247,83 @@ vector < int >NoximRouter::routingXY(const NoximCoord & current,
     return directions;
 }
 
+vector < int >NoximRouter::routingTorusXY(const NoximCoord & current,
+					  const NoximCoord & destination)
+{
+    vector < int >directions;
+    int dim_x = NoximGlobalParams::mesh_dim_x;
+    int dim_y = NoximGlobalParams::mesh_dim_y;
+
+    // hops needed along each ring going towards east and south; the
+    // shortest way round is taken, east/south on ties
+    int dx = (destination.x - current.x + dim_x) % dim_x;
+    int dy = (destination.y - current.y + dim_y) % dim_y;
+
+    if (dx != 0)
+	directions.push_back(2 * dx <= dim_x ? DIRECTION_EAST : DIRECTION_WEST);
+    else if (dy != 0)
+	directions.push_back(2 * dy <= dim_y ? DIRECTION_SOUTH : DIRECTION_NORTH);
+    else
+	directions.push_back(DIRECTION_NORTH);
+
+    return directions;
+}
+
+vector < int >NoximRouter::routingChipXY(const NoximCoord & current,
+					 const NoximCoord & destination)
+{
+    int w = chipWidth();
+    int h = chipHeight();
+    int chip_x = current.x / w;
+    int chip_y = current.y / h;
+    int dst_chip_x = destination.x / w;
+    int dst_chip_y = destination.y / h;
+
+    if (chip_x == dst_chip_x && chip_y == dst_chip_y)
+	return routingXY(current, destination);
+
+    // Chips are crossed in XY order too: the packet heads for the
+    // nearest border router with a link towards the next chip
+    NoximCoord border;
+    int direction;
+
+    if (chip_x != dst_chip_x) {
+	direction = (dst_chip_x > chip_x) ? DIRECTION_EAST : DIRECTION_WEST;
+	border.x = (direction == DIRECTION_EAST) ? (chip_x + 1) * w - 1 : chip_x * w;
+	border.y = chip_y * h + nearestChipLink(current.y - chip_y * h, h);
+    } else {
+	direction = (dst_chip_y > chip_y) ? DIRECTION_SOUTH : DIRECTION_NORTH;
+	border.y = (direction == DIRECTION_SOUTH) ? (chip_y + 1) * h - 1 : chip_y * h;
+	border.x = chip_x * w + nearestChipLink(current.x - chip_x * w, w);
+    }
+
+    if (current == border)
+	return vector < int >(1, direction);
+
+    return routingXY(current, border);
+}
+
+vector < int >NoximRouter::routingExpressXY(const NoximCoord & current,
+					    const NoximCoord & destination)
+{
+    vector < int >directions = routingXY(current, destination);
+    int direction = directions[0];
+
+    // Express links are taken as long as they do not overshoot the
+    // destination along the current dimension
+    int distance;
+    if (direction == DIRECTION_EAST || direction == DIRECTION_WEST)
+	distance = abs(destination.x - current.x);
+    else
+	distance = abs(destination.y - current.y);
+
+    if (distance >= NoximGlobalParams::express_span &&
+	expressNeighbor(local_id, direction) != NOT_VALID)
+	directions[0] = expressPort(direction);
+
+    return directions;
+}
+
 vector < int >NoximRouter::routingWestFirst(const NoximCoord & current,
 					    const NoximCoord & destination)
 {
@@ -641,8 +1487,15 @@ vector < int >NoximRouter::routingTableBased(const int dir_in,
 					     const NoximCoord &
 					     destination)
 {
-    NoximAdmissibleOutputs ao =
-	routing_table.getAdmissibleOutputs(dir_in, coord2Id(destination));
+    NoximAdmissibleOutputs ao;
+
+    if (NoximGlobalParams::topology == TOPOLOGY_GRAPH) {
+	// channels of a graph are not implied by the directions
+	int src = (dir_in == DIRECTION_LOCAL) ? local_id : neighbor_id[dir_in];
+	ao = routing_table.getAdmissibleOutputs(NoximLinkId(src, local_id),
+						coord2Id(destination));
+    } else
+	ao = routing_table.getAdmissibleOutputs(dir_in, coord2Id(destination));
 
     if (ao.size() == 0) {
 	cout << "dir: " << dir_in << ", (" << current.x << "," << current.
@@ -664,35 +1517,228 @@ vector < int >NoximRouter::routingTableBased(const int dir_in,
      */
     //-----
 
+    if (NoximGlobalParams::topology == TOPOLOGY_GRAPH) {
+	vector < int >dirs;
+	for (NoximAdmissibleOutputs::iterator i = ao.begin(); i != ao.end();
+	     i++)
+	    dirs.push_back(portTowards(i->second));
+	return dirs;
+    }
+
     return admissibleOutputsSet2Vector(ao);
 }
 
+int NoximRouter::portTowards(const int neighbor) const
+{
+    if (neighbor == local_id)
+	return DIRECTION_LOCAL;
+
+    for (int p = 0; p < network_ports; p++)
+	if (getNeighborId(local_id, graphRouterPort(p)) == neighbor)
+	    return graphRouterPort(p);
+
+    // the routing table uses a link that does not exist
+    cout << "Router[" << local_id << "] is not connected to " << neighbor
+	<< endl;
+    assert(false);
+    return NOT_VALID;
+}
+
 void NoximRouter::configure(const int _id,
 			    const double _warm_up_time,
 			    const unsigned int _max_buffer_size,
-			    NoximGlobalRoutingTable & grt)
+			    NoximGlobalRoutingTable & grt,
+			    NoximGlobalTopology & gtop)
 {
     local_id = _id;
     stats.configure(_id, _warm_up_time);
 
-    start_from_port = DIRECTION_LOCAL;
+    // The mesh ports are always there, a graph router may number more
+    network_ports = DIRECTIONS;
+    if (NoximGlobalParams::express_span > 0)
+	network_ports += EXPRESS_DIRECTIONS;
+    if (NoximGlobalParams::topology == TOPOLOGY_GRAPH)
+	network_ports = max(network_ports, gtop.getDegree(_id));
+
+    // the SMART side network may settle before the first reset
+    for (int i = 0; i < DIRECTIONS; i++) {
+	bypass_hops[i] = 0;
+	bypass_request[i] = NOT_VALID;
+	bypass_answered[i] = false;
+	bypass_granted[i] = false;
+	bypassing[i] = false;
+    }
+
+    // Reservations and allocation work on virtual channels
+    int n_ports = ports() * NoximGlobalParams::virtual_channels;
+
+    reservation_table.configure(n_ports);
+    switch_allocator.configure(n_ports,
+			       NoximGlobalParams::switch_allocator,
+			       NoximGlobalParams::islip_iterations,
+			       _warm_up_time);
 
     if (grt.isValid())
 	routing_table.configure(grt, _id);
 
-    for (int i = 0; i < DIRECTIONS + 1; i++)
-	buffer[i].SetMaxBufferSize(_max_buffer_size);
+    for (int i = 0; i < ports(); i++) {
+	for (int vc = 0; vc < MAX_VIRTUAL_CHANNELS; vc++)
+	    buffer[i][vc].SetMaxBufferSize(_max_buffer_size);
+	link_length[i] = linkLength(i);
+
+	// A link crossed in one cycle adds no delay, the links towards
+	// the PEs always take one cycle
+	link_delay[i] = isLocal(i) ? 0 : NoximGlobalParams::link_latency - 1;
+	link_period[i] = NoximGlobalParams::link_pipelining ? 1 : link_delay[i] + 1;
+    }
+
+    if (NoximGlobalParams::topology == TOPOLOGY_GRAPH) {
+	// Neighbors and link latencies come from the topology file
+	for (int p = 0; p < network_ports; p++) {
+	    int i = graphRouterPort(p);
+	    neighbor_id[i] = gtop.getNeighbor(_id, p);
+	    if (neighbor_id[i] == NOT_VALID)
+		tieOff(i);
+	    else {
+		link_delay[i] = gtop.getLatency(_id, p) - 1;
+		if (!NoximGlobalParams::link_pipelining)
+		    link_period[i] = link_delay[i] + 1;
+	    }
+	}
+	return;
+    }
+
+    // Tori have no boundary
+    if (NoximGlobalParams::topology != TOPOLOGY_MESH)
+	return;
 
     int row = _id / NoximGlobalParams::mesh_dim_x;
     int col = _id % NoximGlobalParams::mesh_dim_x;
     if (row == 0)
-      buffer[DIRECTION_NORTH].Disable();
+      tieOff(DIRECTION_NORTH);
     if (row == NoximGlobalParams::mesh_dim_y-1)
-      buffer[DIRECTION_SOUTH].Disable();
+      tieOff(DIRECTION_SOUTH);
     if (col == 0)
-      buffer[DIRECTION_WEST].Disable();
+      tieOff(DIRECTION_WEST);
     if (col == NoximGlobalParams::mesh_dim_x-1)
-      buffer[DIRECTION_EAST].Disable();
+      tieOff(DIRECTION_EAST);
+
+    // Express links span several tiles
+    if (NoximGlobalParams::express_span > 0)
+      for (int d = 0; d < EXPRESS_DIRECTIONS; d++)
+	{
+	  int o = expressPort(d);
+
+	  if (expressNeighbor(_id, d) == NOT_VALID)
+	    tieOff(o);
+	  else
+	    {
+	      link_delay[o] = NoximGlobalParams::express_latency - 1;
+	      if (!NoximGlobalParams::link_pipelining)
+		link_period[o] = link_delay[o] + 1;
+	    }
+	}
+
+    // Inter-chip links are slower and the chip edges only keep some of
+    // the links of the mesh
+    for (int i = 0; i < DIRECTIONS; i++)
+      if (crossesChip(i))
+	{
+	  if (hasChipLink(i))
+	    {
+	      link_delay[i] = NoximGlobalParams::chip_link_latency - 1;
+	      link_period[i] = NoximGlobalParams::chip_link_period;
+	    }
+	  else
+	    tieOff(i);
+	}
+}
+
+void NoximRouter::tieOff(const int port)
+{
+    for (int vc = 0; vc < NoximGlobalParams::virtual_channels; vc++) {
+	buffer[port][vc].Disable();
+	reservation_table.invalidate(virtualPort(port, vc));
+    }
+}
+
+bool NoximRouter::hasChipLink(const int direction) const
+{
+    NoximCoord position = id2Coord(local_id);
+    int offset, k;
+
+    if (direction == DIRECTION_EAST || direction == DIRECTION_WEST) {
+	offset = position.y % chipHeight();
+	k = chipHeight();
+    } else {
+	offset = position.x % chipWidth();
+	k = chipWidth();
+    }
+
+    return nearestChipLink(offset, k) == offset;
+}
+
+int NoximRouter::nearestChipLink(const int offset, const int k) const
+{
+    int nearest = chipLinkOffset(0, k);
+
+    for (int n = 1; n < NoximGlobalParams::chip_links; n++)
+	if (abs(chipLinkOffset(n, k) - offset) < abs(nearest - offset))
+	    nearest = chipLinkOffset(n, k);
+
+    return nearest;
+}
+
+double NoximRouter::linkLength(const int direction) const
+{
+    if (NoximGlobalParams::express_span > 0 &&
+	direction >= expressPort(0))
+	return (double) NoximGlobalParams::express_span;
+
+    // The router-PE links and the links of a mesh span one tile, the
+    // floorplan of a graph is unknown
+    if (isLocal(direction) ||
+	NoximGlobalParams::topology == TOPOLOGY_MESH ||
+	NoximGlobalParams::topology == TOPOLOGY_GRAPH)
+	return 1.0;
+
+    NoximCoord position = id2Coord(local_id);
+    int n, k;			// position and size of the ring
+
+    if (direction == DIRECTION_EAST || direction == DIRECTION_WEST) {
+	n = position.x;
+	k = NoximGlobalParams::mesh_dim_x;
+    } else {
+	n = position.y;
+	k = NoximGlobalParams::mesh_dim_y;
+    }
+
+    int next = n;
+    if (direction == DIRECTION_EAST || direction == DIRECTION_SOUTH)
+	next = (n + 1) % k;
+    else
+	next = (n + k - 1) % k;
+
+    if (NoximGlobalParams::topology == TOPOLOGY_TORUS)
+	return (double) abs(next - n);
+
+    // The folded torus interleaves the ring on the floorplan: node n
+    // sits in slot 2n in the first half and in slot 2(k-1-n)+1 in the
+    // second one, so that all links span at most two tiles
+    int slot = (n < (k + 1) / 2) ? 2 * n : 2 * (k - 1 - n) + 1;
+    int next_slot = (next < (k + 1) / 2) ? 2 * next : 2 * (k - 1 - next) + 1;
+
+    return (double) abs(next_slot - slot);
+}
+
+int NoximRouter::freeSlots(const int i) const
+{
+    int slots = 0;
+
+    for (int vc = 0; vc < NoximGlobalParams::virtual_channels; vc++)
+	slots += buffer[i][vc].getCurrentFreeSlots();
+
+    return slots;
 }
 
 unsigned long NoximRouter::getRoutedFlits()
@@ -700,12 +1746,25 @@ unsigned long NoximRouter::getRoutedFlits()
     return routed_flits;
 }
 
+unsigned long NoximRouter::getDroppedFlits()
+{
+    return dropped_flits;
+}
+
+unsigned long NoximRouter::getBypassedFlits()
+{
+    return bypassed_flits;
+}
+
 unsigned int NoximRouter::getFlitsCount()
 {
     unsigned count = 0;
 
-    for (int i = 0; i < DIRECTIONS + 1; i++)
-	count += buffer[i].Size();
+    for (int i = 0; i < ports(); i++) {
+	for (int vc = 0; vc < NoximGlobalParams::virtual_channels; vc++)
+	    count += buffer[i][vc].Size();
+	count += output_stages[i].size();
+    }
 
     return count;
 }
@@ -733,28 +1792,38 @@ int NoximRouter::reflexDirection(int direction) const
 
 int NoximRouter::getNeighborId(int _id, int direction) const
 {
+    // The neighbors of a graph are only known for this router
+    if (NoximGlobalParams::topology == TOPOLOGY_GRAPH) {
+	assert(_id == local_id);
+	assert(direction >= 0 && direction < ports() && !isLocal(direction));
+	return neighbor_id[direction];
+    }
+
     NoximCoord my_coord = id2Coord(_id);
+    int dim_x = NoximGlobalParams::mesh_dim_x;
+    int dim_y = NoximGlobalParams::mesh_dim_y;
+    bool torus = (NoximGlobalParams::topology != TOPOLOGY_MESH);
 
     switch (direction) {
     case DIRECTION_NORTH:
-	if (my_coord.y == 0)
+	if (my_coord.y == 0 && !torus)
 	    return NOT_VALID;
-	my_coord.y--;
+	my_coord.y = (my_coord.y + dim_y - 1) % dim_y;
 	break;
     case DIRECTION_SOUTH:
-	if (my_coord.y == NoximGlobalParams::mesh_dim_y - 1)
+	if (my_coord.y == dim_y - 1 && !torus)
 	    return NOT_VALID;
-	my_coord.y++;
+	my_coord.y = (my_coord.y + 1) % dim_y;
 	break;
     case DIRECTION_EAST:
-	if (my_coord.x == NoximGlobalParams::mesh_dim_x - 1)
+	if (my_coord.x == dim_x - 1 && !torus)
 	    return NOT_VALID;
-	my_coord.x++;
+	my_coord.x = (my_coord.x + 1) % dim_x;
 	break;
     case DIRECTION_WEST:
-	if (my_coord.x == 0)
+	if (my_coord.x == 0 && !torus)
 	    return NOT_VALID;
-	my_coord.x--;
+	my_coord.x = (my_coord.x + dim_x - 1) % dim_x;
 	break;
     default:
 	cout << "direction not valid : " << direction;
@@ -782,6 +1851,7 @@ bool NoximRouter::inCongestion()
 
 void NoximRouter::ShowBuffersStats(std::ostream & out)
 {
-  for (int i=0; i<DIRECTIONS+1; i++)
-    buffer[i].ShowStats(out);
+  for (int i=0; i<ports(); i++)
+    for (int vc=0; vc<NoximGlobalParams::virtual_channels; vc++)
+      buffer[i][vc].ShowStats(out);
 }
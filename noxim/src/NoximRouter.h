@@ -11,17 +11,27 @@
 #ifndef __NOXIMROUTER_H__
 #define __NOXIMROUTER_H__
 
+#include <queue>
 #include <systemc.h>
 #include "NoximMain.h"
 #include "NoximBuffer.h"
 #include "NoximStats.h"
 #include "NoximGlobalRoutingTable.h"
+#include "NoximGlobalTopology.h"
 #include "NoximLocalRoutingTable.h"
 #include "NoximReservationTable.h"
+#include "NoximSwitchAllocator.h"
 using namespace std;
 
 extern unsigned int drained_volume;
 
+// NoximStagedFlit -- Flit in the switch/link traversal stages of an output
+struct NoximStagedFlit {
+    NoximFlit flit;
+    int dir_in;			// Input the flit came from
+    double ready_time;		// Cycle from which it can use the link
+};
+
 SC_MODULE(NoximRouter)
 {
 
@@ -29,21 +39,36 @@ SC_MODULE(NoximRouter)
     sc_in_clk clock;		                  // The input clock for the router
     sc_in <bool> reset;                           // The reset signal for the router
 
-    sc_in <NoximFlit> flit_rx[DIRECTIONS + 1];	  // The input channels (including local one)
-    sc_in <bool> req_rx[DIRECTIONS + 1];	  // The requests associated with the input channels
-    sc_out <bool> ack_rx[DIRECTIONS + 1];	  // The outgoing ack signals associated with the input channels
+    sc_in <NoximFlitBundle> flit_rx[MAX_ROUTER_PORTS];	  // The input channels (including local and express ones)
+    sc_in <bool> req_rx[MAX_ROUTER_PORTS];	  // The requests associated with the input channels
+    sc_out <bool> ack_rx[MAX_ROUTER_PORTS];	  // The outgoing ack signals associated with the input channels
 
-    sc_out <NoximFlit> flit_tx[DIRECTIONS + 1];   // The output channels (including local one)
-    sc_out <bool> req_tx[DIRECTIONS + 1];	  // The requests associated with the output channels
-    sc_in <bool> ack_tx[DIRECTIONS + 1];	  // The outgoing ack signals associated with the output channels
+    sc_out <NoximFlitBundle> flit_tx[MAX_ROUTER_PORTS];   // The output channels (including local and express ones)
+    sc_out <bool> req_tx[MAX_ROUTER_PORTS];	  // The requests associated with the output channels
+    sc_in <bool> ack_tx[MAX_ROUTER_PORTS];	  // The outgoing ack signals associated with the output channels
 
-    sc_out <int> free_slots[DIRECTIONS + 1];
-    sc_in <int> free_slots_neighbor[DIRECTIONS + 1];
+    sc_out <int> free_slots[MAX_ROUTER_PORTS];
+    sc_in <int> free_slots_neighbor[MAX_ROUTER_PORTS];
+
+    // Virtual channel credits
+    sc_out <NoximCreditCount> credits[DIRECTIONS];
+    sc_in <NoximCreditCount> credits_neighbor[DIRECTIONS];
 
     // Neighbor-on-Path related I/O
     sc_out < NoximNoP_data > NoP_data_out[DIRECTIONS];
     sc_in < NoximNoP_data > NoP_data_in[DIRECTIONS];
 
+    // Regional congestion side network: congestion_in[d] carries the
+    // estimate of the region beyond the neighbor in direction d
+    sc_out <double> congestion_out[DIRECTIONS];
+    sc_in <double> congestion_in[DIRECTIONS];
+
+    // SMART bypass side network: smart_in[d] carries the setup requests
+    // and the flits coming from the neighbor in direction d, and its
+    // answers to the ones sent to it
+    sc_out <NoximSmartLink> smart_out[DIRECTIONS];
+    sc_in <NoximSmartLink> smart_in[DIRECTIONS];
+
     // Registers
 
     /*
@@ -52,25 +77,72 @@ SC_MODULE(NoximRouter)
     int local_id;		                // Unique ID
     int routing_type;		                // Type of routing algorithm
     int selection_type;
-    NoximBuffer buffer[DIRECTIONS + 1];	        // Buffer for each input channel 
-    bool current_level_rx[DIRECTIONS + 1];	// Current level for Alternating Bit Protocol (ABP)
-    bool current_level_tx[DIRECTIONS + 1];	// Current level for Alternating Bit Protocol (ABP)
+    NoximBuffer buffer[MAX_ROUTER_PORTS][MAX_VIRTUAL_CHANNELS];	// Buffer for each virtual channel of each input
+    bool current_level_rx[MAX_ROUTER_PORTS];	// Current level for Alternating Bit Protocol (ABP)
+    bool current_level_tx[MAX_ROUTER_PORTS];	// Current level for Alternating Bit Protocol (ABP)
     NoximStats stats;		                // Statistics
     NoximLocalRoutingTable routing_table;	// Routing table
     NoximReservationTable reservation_table;	// Switch reservation table
-    int start_from_port;	                // Port from which to start the reservation cycle
+    NoximSwitchAllocator switch_allocator;	// Matches head flits to free outputs
+    queue <double> arrival_time[MAX_ROUTER_PORTS][MAX_VIRTUAL_CHANNELS];	// Arrival cycle of the buffered flits
+    double grant_time[MAX_ROUTER_PORTS][MAX_VIRTUAL_CHANNELS];	// Cycle in which each input won its output
+    int vc_priority[MAX_ROUTER_PORTS];	        // First virtual channel served at each input
+    NoximCreditCount drained_flits[DIRECTIONS];	// Flits that left each input virtual channel
+    NoximCreditCount sent_flits[DIRECTIONS];	// Flits sent on each output virtual channel
+    double link_length[MAX_ROUTER_PORTS];	        // Length of the output links, in tiles
+    int link_delay[MAX_ROUTER_PORTS];	        // Extra cycles needed by the output links
+    int link_period[MAX_ROUTER_PORTS];	        // Cycles between two transfers on the output links
+    double link_free_time[MAX_ROUTER_PORTS];	// Cycle from which an output link can be used again
+    int neighbor_id[MAX_ROUTER_PORTS];	        // Routers connected to a graph topology
+    int network_ports;		                // Mesh ports and express ports in use
+    queue <NoximStagedFlit> output_stages[MAX_ROUTER_PORTS];	// Flits traversing switch and link
+    int bypass_hops[DIRECTIONS];	        // Routers skipped by the packet on each output
+    int bypass_request[DIRECTIONS];	        // Destination of the setup request sent on each output
+    bool bypass_answered[DIRECTIONS];	        // The head on each output may go
+    NoximFlitBundle bypass_flits[DIRECTIONS];	// Flits sent through the bypass on each output
+    bool bypass_granted[DIRECTIONS];	        // Setup request granted for the packets going each way
+    bool bypassing[DIRECTIONS];	                // Straight through for the packets going each way
     unsigned long routed_flits;
+    unsigned long bypassed_flits;	        // Flits that went straight through
+    bool draining[MAX_ROUTER_PORTS][MAX_VIRTUAL_CHANNELS];	// Input dropping a packet up to its tail
+    unsigned long dropped_flits;	        // Flits dropped by deadlock recovery
 
     // Functions
 
     void rxProcess();		// The receiving process
     void txProcess();		// The transmitting process
     void bufferMonitor();
+    void smartProcess();	// Drives the SMART side network
     void configure(const int _id, const double _warm_up_time,
 		   const unsigned int _max_buffer_size,
-		   NoximGlobalRoutingTable & grt);
+		   NoximGlobalRoutingTable & grt,
+		   NoximGlobalTopology & gtop);
 
     unsigned long getRoutedFlits();	// Returns the number of routed flits 
+    unsigned long getBypassedFlits();	// Returns the number of flits that bypassed the router
+    unsigned long getDroppedFlits();	// Returns the number of flits dropped by deadlock recovery
+
+    // Virtual output ports the flit at the front of input virtual
+    // channel (i, vc) is waiting for: the one it holds or, for a head
+    // still to be allocated, all the admissible ones
+    vector <int> waitedOutputs(const int i, const int vc);
+
+    // Drops the packet at the front of input virtual channel (i, vc),
+    // including the flits still to come up to its tail
+    void drainPacket(const int i, const int vc);
+
+    // Outputs a head flit may take at zero load: the candidates of
+    // routeCandidates(), without charging energy, with the algorithms
+    // that react to congestion taken as if the network were empty
+    vector <int> zeroLoadOutputs(const NoximRouteData & route_data);
+
+    // Cycles a head flit needs, when nothing stands in its way, from
+    // its arrival to the next router or to the PE through output
+    // port_out
+    int zeroLoadDelay(const int port_out) const;
+
+    // Flits per cycle output port_out carries at most
+    double outputCapacity(const int port_out) const;
     unsigned int getFlitsCount();	// Returns the number of flits into the router
     double getPower();		        // Returns the total power dissipated by the router
 
@@ -88,13 +160,86 @@ SC_MODULE(NoximRouter)
 	SC_METHOD(bufferMonitor);
 	sensitive << reset;
 	sensitive << clock.pos();
+
+	// The SMART side network settles between two clock edges, on the
+	// state the routers left at the last one
+	if (NoximGlobalParams::smart_hpc_max > 1) {
+	    SC_METHOD(smartProcess);
+	    sensitive << clock.neg();
+	    for (int d = 0; d < DIRECTIONS; d++)
+		sensitive << smart_in[d];
+	}
     }
 
   private:
 
+    // txProcess() phases. With a crossbar speedup S, reallocation and
+    // forwarding are repeated S-1 more times per cycle.
+    void reservationPhase();
+    void reallocationPhase();
+    void grantPhase(const vector < int >&grants);
+    void forwardingPhase(NoximFlitBundle bundle[]);
+
+    // Throws away the flits of the packets being drained
+    void drainingPhase();
+
+    // Moves the flits that completed the output stages onto the links
+    void linkTraversalPhase(NoximFlitBundle bundle[]);
+    void linkTraversal(const int i, const int o, const NoximFlit & flit,
+		       NoximFlitBundle & bundle);
+
+    // Network ports followed by one local port for each attached PE
+    // and by the express ports in use: all of them with express links,
+    // the ones a graph router numbers past the mesh ports
+    int ports() const;
+    bool isLocal(const int port) const;
+    int expressPort(const int direction) const;
+
+    // Pipeline depth before the allocation and after the switch
+    int routingStages() const;
+    int outputStages() const;
+
+    // Output stages plus the extra latency of the output link
+    int outputDelay(const int port_out) const;
+
+    // Virtual channels: reservations and allocation use port*VCs+vc
+    int virtualPort(const int port, const int vc) const;
+    bool outputAvailable(const int port_out) const;
+    bool crossesDateline(const int dir_out) const;
+    bool crossesChip(const int dir_out) const;
+    int outputVirtualChannel(const int dir_in, const int vc_in,
+			     const int dir_out) const;
+    bool hasCredit(const int port_out, const int vc) const;
+    bool canAccept(const int i, const NoximFlitBundle & bundle) const;
+    int freeSlots(const int i) const;
+
+    double linkLength(const int direction) const;
+
+    // SMART bypass: a packet goes through up to smart_hpc_max - 1 idle
+    // routers of its straight path in a single cycle. The head sends a
+    // setup request and waits for the answer, the next cycle.
+    bool goesStraight(const int id, const int o, const int dst) const;
+    bool canBypass(const int in, const int o, const int dst) const;
+    bool awaitsBypass(const int o, const NoximFlit & flit);
+    int bypassSlots(const int o) const;
+
+    // Accounts for the flits that went through or landed in the last
+    // cycle and latches the setups resolved in the meantime
+    void bypassPhase();
+
+    // Multi-chip meshes: only some of the links between two chips exist
+    bool hasChipLink(const int direction) const;
+    int nearestChipLink(const int offset, const int k) const;
+
+    // Disables a port without link on every virtual channel
+    void tieOff(const int port);
+
     // performs actual routing + selection
     int route(const NoximRouteData & route_data);
 
+    // performs routing only, returning every admissible output
+    vector < int >routeCandidates(const NoximRouteData & route_data);
+
     // wrappers
     int selectionFunction(const vector <int> &directions,
 			  const NoximRouteData & route_data);
@@ -105,10 +250,17 @@ SC_MODULE(NoximRouter)
     int selectionBufferLevel(const vector <int> & directions);
     int selectionNoP(const vector <int> & directions,
 		     const NoximRouteData & route_data);
+    int selectionRCA(const vector <int> & directions);
 
     // routing functions
     vector < int >routingXY(const NoximCoord & current,
 			    const NoximCoord & destination);
+    vector < int >routingTorusXY(const NoximCoord & current,
+				 const NoximCoord & destination);
+    vector < int >routingChipXY(const NoximCoord & current,
+				const NoximCoord & destination);
+    vector < int >routingExpressXY(const NoximCoord & current,
+				   const NoximCoord & destination);
     vector < int >routingWestFirst(const NoximCoord & current,
 				   const NoximCoord & destination);
     vector < int >routingNorthLast(const NoximCoord & current,
@@ -128,9 +280,11 @@ SC_MODULE(NoximRouter)
     vector < int >routingTableBased(const int dir_in,
 				    const NoximCoord & current,
 				    const NoximCoord & destination);
+    int portTowards(const int neighbor) const;
     NoximNoP_data getCurrentNoPData() const;
     void NoP_report() const;
     int NoPScore(const NoximNoP_data & nop_data, const vector <int> & nop_channels) const;
+    double regionalCongestion(const int dir) const;
     int reflexDirection(int direction) const;
     int getNeighborId(int _id, int direction) const;
     bool inCongestion();
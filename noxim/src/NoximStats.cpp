@@ -16,6 +16,7 @@ void NoximStats::configure(const int node_id, const double _warm_up_time)
 {
     id = node_id;
     warm_up_time = _warm_up_time;
+    total_delay = 0.0;
 }
 
 void NoximStats::receivedFlit(const double arrival_time,
@@ -33,13 +34,17 @@ void NoximStats::receivedFlit(const double arrival_time,
 
 	ch.src_id = flit.src_id;
 	ch.total_received_flits = 0;
+	ch.total_hops = 0;
 	chist.push_back(ch);
 
 	i = chist.size() - 1;
     }
 
-    if (flit.flit_type == FLIT_TYPE_HEAD)
+    if (flit.flit_type == FLIT_TYPE_HEAD) {
 	chist[i].delays.push_back(arrival_time - flit.timestamp);
+	chist[i].total_hops += flit.hop_no;
+	total_delay += arrival_time - flit.timestamp;
+    }
 
     chist[i].total_received_flits++;
     chist[i].last_received_flit_time = arrival_time - warm_up_time;
@@ -150,6 +155,45 @@ unsigned int NoximStats::getReceivedFlits()
     return n;
 }
 
+double NoximStats::getTotalDelay()
+{
+    return total_delay;
+}
+
+unsigned int NoximStats::getChipReceivedPackets(const bool inter_chip)
+{
+    int n = 0;
+
+    for (unsigned int i = 0; i < chist.size(); i++)
+	if ((chipId(peRouterId(chist[i].src_id)) != chipId(id)) == inter_chip)
+	    n += chist[i].delays.size();
+
+    return n;
+}
+
+unsigned int NoximStats::getChipReceivedFlits(const bool inter_chip)
+{
+    int n = 0;
+
+    for (unsigned int i = 0; i < chist.size(); i++)
+	if ((chipId(peRouterId(chist[i].src_id)) != chipId(id)) == inter_chip)
+	    n += chist[i].total_received_flits;
+
+    return n;
+}
+
+double NoximStats::getChipTotalDelay(const bool inter_chip)
+{
+    double sum = 0.0;
+
+    for (unsigned int i = 0; i < chist.size(); i++)
+	if ((chipId(peRouterId(chist[i].src_id)) != chipId(id)) == inter_chip)
+	    for (unsigned int j = 0; j < chist[i].delays.size(); j++)
+		sum += chist[i].delays[j];
+
+    return sum;
+}
+
 unsigned int NoximStats::getTotalCommunications()
 {
     return chist.size();
@@ -157,27 +201,23 @@ unsigned int NoximStats::getTotalCommunications()
 
 double NoximStats::getCommunicationEnergy(int src_id, int dst_id)
 {
-  // NOT YET IMPLEMENTED
-    // Assumptions: minimal path routing, constant packet size
-  /*
-    NoximCoord src_coord = id2Coord(src_id);
-    NoximCoord dst_coord = id2Coord(dst_id);
+    // The hops are the ones the packets actually took, so that every
+    // topology and routing algorithm is accounted for
+    int i = searchCommHistory(src_id);
+    if (i == -1 || chist[i].delays.empty())
+	return 0.0;
 
-    int hops =
-	abs(src_coord.x - dst_coord.x) + abs(src_coord.y - dst_coord.y);
+    double hops = (double) chist[i].total_hops / chist[i].delays.size();
 
     double energy =
-	hops * (power.getPwrArbitration() + power.getPwrCrossbar() +
-		 power.getPwrBuffering() *
+	hops * (power.getArbitration() + power.getCrossbar() +
+		power.getPwrBuffering() *
 		(NoximGlobalParams::min_packet_size +
 		 NoximGlobalParams::max_packet_size) / 2 +
 		power.getPwrRouting() + power.getPwrSelection()
 	);
 
     return energy;
-  */
-  assert(false);
-  return -1.0;
 }
 
 int NoximStats::searchCommHistory(int src_id)
@@ -23,6 +23,7 @@ struct CommHistory {
      vector < double >delays;
     unsigned int total_received_flits;
     double last_received_flit_time;
+    unsigned long total_hops;	// Links crossed by the head flits
 };
 
 class NoximStats {
@@ -64,14 +65,26 @@ class NoximStats {
     // Returns the number of received flits from current node
     unsigned int getReceivedFlits();
 
+    // Returns the sum of the delays of the packets received so far
+    double getTotalDelay();
+
+    // Multi-chip meshes: packets, flits and sum of the packet delays
+    // received from the PEs of the other chips (inter_chip) or of the
+    // chip of the current node
+    unsigned int getChipReceivedPackets(const bool inter_chip);
+    unsigned int getChipReceivedFlits(const bool inter_chip);
+    double getChipTotalDelay(const bool inter_chip);
+
     // Returns the number of communications whose destination is the
     // current node
     unsigned int getTotalCommunications();
 
-    // Returns the energy consumed for communication src_id-->dst_id
-    // under the following assumptions: (i) Minimal routing is
-    // considered, (ii) constant packet size is considered (as the
-    // average between the minimum and the maximum packet size).
+    // Returns the energy consumed by a packet of the communication
+    // src_id-->dst_id under the following assumptions: (i) the packet
+    // crosses the average number of links between routers crossed by
+    // the packets received so far, (ii) constant packet size is
+    // considered (as the average between the minimum and the maximum
+    // packet size).
     double getCommunicationEnergy(int src_id, int dst_id);
 
     // Shows statistics for the current node
@@ -87,6 +100,7 @@ class NoximStats {
     int id;
     vector < CommHistory > chist;
     double warm_up_time;
+    double total_delay;
 
     int searchCommHistory(int src_id);
 };
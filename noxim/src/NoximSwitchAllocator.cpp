@@ -0,0 +1,354 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the switch allocator
+ */
+
+#include "NoximSwitchAllocator.h"
+
+NoximSwitchAllocator::NoximSwitchAllocator()
+{
+    configure(DIRECTIONS + 1, DEFAULT_SWITCH_ALLOCATOR,
+	      DEFAULT_ISLIP_ITERATIONS, 0.0);
+}
+
+void NoximSwitchAllocator::configure(const int _n_ports, const int _type,
+				     const int _iterations,
+				     const double _warm_up_time)
+{
+    n_ports = _n_ports;
+    type = _type;
+    iterations = _iterations;
+    warm_up_time = _warm_up_time;
+
+    requests.assign(n_ports, vector <bool> (n_ports, false));
+    eligible.assign(n_ports, vector <bool> (n_ports, false));
+    served.assign(n_ports, NOT_VALID);
+
+    start_from_port = DIRECTION_LOCAL % n_ports;
+    grant_pointer.assign(n_ports, 0);
+    accept_pointer.assign(n_ports, 0);
+    priority_diagonal = 0;
+
+    requesting_inputs = 0;
+    granted = 0;
+    max_granted = 0;
+}
+
+bool NoximSwitchAllocator::acceptsMultipleRequests() const
+{
+    return type != SWITCH_ALLOC_ROUND_ROBIN;
+}
+
+void NoximSwitchAllocator::clearRequests()
+{
+    for (int i = 0; i < n_ports; i++) {
+	for (int o = 0; o < n_ports; o++) {
+	    requests[i][o] = false;
+	    eligible[i][o] = false;
+	}
+	served[i] = NOT_VALID;
+    }
+    available.clear();
+}
+
+int NoximSwitchAllocator::firstInput() const
+{
+    return start_from_port;
+}
+
+void NoximSwitchAllocator::request(const int port_in, const int port_out)
+{
+    assert(port_in >= 0 && port_in < n_ports);
+    assert(port_out >= 0 && port_out < n_ports);
+
+    requests[port_in][port_out] = true;
+}
+
+int NoximSwitchAllocator::serve(NoximReservationTable & rtable,
+				const int port_in)
+{
+    assert(!acceptsMultipleRequests());
+    assert(port_in >= 0 && port_in < n_ports);
+
+    // Efficiency is measured against the outputs that were free before
+    // the first input of the cycle was served
+    if (available.empty())
+	for (int o = 0; o < n_ports; o++)
+	    available.push_back(rtable.isAvailable(o));
+
+    for (int o = 0; o < n_ports; o++)
+	eligible[port_in][o] = requests[port_in][o] && available[o];
+
+    // The input takes the first free output it asked for
+    for (int o = 0; o < n_ports; o++)
+	if (requests[port_in][o] && rtable.isAvailable(o)) {
+	    rtable.reserve(port_in, o);
+	    served[port_in] = o;
+	    return o;
+	}
+
+    // An input that keeps the output it already holds may send its
+    // whole packet in this cycle: it does not compete again
+    if (rtable.getOutputPort(port_in) != NOT_RESERVED)
+	for (int o = 0; o < n_ports; o++)
+	    requests[port_in][o] = false;
+
+    return NOT_VALID;
+}
+
+int NoximSwitchAllocator::allocate(NoximReservationTable & rtable,
+				   vector <int> & grants)
+{
+    grants.assign(n_ports, NOT_VALID);
+
+    // Requests that can actually be satisfied in this cycle. Matching
+    // allocators leave alone the inputs that already own an output,
+    // round-robin has evaluated them input by input in serve().
+    if (acceptsMultipleRequests())
+	for (int i = 0; i < n_ports; i++) {
+	    bool busy = rtable.getOutputPort(i) != NOT_RESERVED;
+	    for (int o = 0; o < n_ports; o++)
+		eligible[i][o] = !busy && requests[i][o]
+		    && rtable.isAvailable(o);
+	}
+
+    int inputs = 0;
+    for (int i = 0; i < n_ports; i++)
+	for (int o = 0; o < n_ports; o++)
+	    if (eligible[i][o]) {
+		inputs++;
+		break;
+	    }
+
+    // Do not bother the allocator when there is nothing to match
+    if (!acceptsMultipleRequests())
+	grants = served;
+    else if (inputs > 0)
+	match(eligible, rtable, grants, true);
+    served = grants;
+
+    // Outputs freed by a round-robin re-reservation may be taken in the
+    // same cycle: efficiency only accounts for the eligible requests
+    int n_grants = 0;
+    int n_eligible_grants = 0;
+    for (int i = 0; i < n_ports; i++)
+	if (grants[i] != NOT_VALID) {
+	    n_grants++;
+	    if (eligible[i][grants[i]])
+		n_eligible_grants++;
+	}
+
+    double now = sc_time_stamp().to_double() / 1000;
+    if (inputs > 0 && now - DEFAULT_RESET_TIME >= warm_up_time) {
+	requesting_inputs += inputs;
+	granted += n_eligible_grants;
+	max_granted += maximumMatching();
+    }
+
+    return n_grants;
+}
+
+int NoximSwitchAllocator::reallocate(NoximReservationTable & rtable,
+				     vector <int> & grants)
+{
+    grants.assign(n_ports, NOT_VALID);
+
+    // Only the inputs that have not won an output in this cycle compete
+    // again, for the outputs released in the meantime
+    vector < vector <bool> > pending(n_ports, vector <bool> (n_ports, false));
+    bool any = false;
+    for (int i = 0; i < n_ports; i++) {
+	if (served[i] != NOT_VALID || rtable.getOutputPort(i) != NOT_RESERVED)
+	    continue;
+	for (int o = 0; o < n_ports; o++) {
+	    pending[i][o] = requests[i][o] && rtable.isAvailable(o);
+	    any = any || pending[i][o];
+	}
+    }
+
+    if (!any)
+	return 0;
+
+    if (acceptsMultipleRequests())
+	match(pending, rtable, grants, false);
+    else
+	for (int j = 0; j < n_ports; j++) {
+	    int i = (start_from_port + j) % n_ports;
+	    for (int o = 0; o < n_ports; o++)
+		if (pending[i][o] && rtable.isAvailable(o)) {
+		    rtable.reserve(i, o);
+		    grants[i] = o;
+		    break;
+		}
+	}
+
+    int n_grants = 0;
+    for (int i = 0; i < n_ports; i++)
+	if (grants[i] != NOT_VALID) {
+	    served[i] = grants[i];
+	    n_grants++;
+	}
+
+    return n_grants;
+}
+
+void NoximSwitchAllocator::endCycle()
+{
+    // Advance the fixed rotating priorities even in idle cycles, as
+    // the original reservation loop did
+    start_from_port = (start_from_port + 1) % n_ports;
+    priority_diagonal = (priority_diagonal + 1) % n_ports;
+}
+
+void NoximSwitchAllocator::match(const vector < vector <bool> > & req,
+				 NoximReservationTable & rtable,
+				 vector <int> & grants,
+				 const bool move_pointers)
+{
+    switch (type) {
+    case SWITCH_ALLOC_ISLIP:
+	allocateISLIP(req, rtable, grants, move_pointers);
+	break;
+    case SWITCH_ALLOC_WAVEFRONT:
+	allocateWavefront(req, rtable, grants);
+	break;
+    default:
+	assert(false);
+    }
+}
+
+void NoximSwitchAllocator::allocateISLIP(const vector < vector <bool> > & req,
+					 NoximReservationTable & rtable,
+					 vector <int> & grants,
+					 const bool move_pointers)
+{
+    vector <bool> out_matched(n_ports, false);
+
+    for (int it = 0; it < iterations; it++) {
+	// Grant: every unmatched output picks the first requesting
+	// unmatched input starting from its pointer
+	vector <int> granted_input(n_ports, NOT_VALID);
+	bool any_grant = false;
+
+	for (int o = 0; o < n_ports; o++) {
+	    if (out_matched[o])
+		continue;
+	    for (int k = 0; k < n_ports; k++) {
+		int i = (grant_pointer[o] + k) % n_ports;
+		if (grants[i] == NOT_VALID && req[i][o]) {
+		    granted_input[o] = i;
+		    any_grant = true;
+		    break;
+		}
+	    }
+	}
+
+	if (!any_grant)
+	    break;
+
+	// Accept: every input picks the first granting output starting
+	// from its pointer. Pointers move only in the first iteration,
+	// which is what makes iSLIP starvation free, and only once per
+	// cycle with a crossbar speedup.
+	for (int i = 0; i < n_ports; i++) {
+	    if (grants[i] != NOT_VALID)
+		continue;
+	    for (int k = 0; k < n_ports; k++) {
+		int o = (accept_pointer[i] + k) % n_ports;
+		if (granted_input[o] == i) {
+		    rtable.reserve(i, o);
+		    grants[i] = o;
+		    out_matched[o] = true;
+		    if (it == 0 && move_pointers) {
+			grant_pointer[o] = (i + 1) % n_ports;
+			accept_pointer[i] = (o + 1) % n_ports;
+		    }
+		    break;
+		}
+	    }
+	}
+    }
+}
+
+void NoximSwitchAllocator::allocateWavefront(const vector < vector <bool> > &
+					     req,
+					     NoximReservationTable & rtable,
+					     vector <int> & grants)
+{
+    vector <bool> out_matched(n_ports, false);
+
+    // Cells (i, (i + d) % n_ports) of a wrapped diagonal d never share
+    // a row or a column, so each diagonal is granted as a whole. The
+    // diagonal holding the highest priority rotates every cycle.
+    for (int k = 0; k < n_ports; k++) {
+	int d = (priority_diagonal + k) % n_ports;
+
+	for (int i = 0; i < n_ports; i++) {
+	    int o = (i + d) % n_ports;
+	    if (grants[i] == NOT_VALID && !out_matched[o] && req[i][o]) {
+		rtable.reserve(i, o);
+		grants[i] = o;
+		out_matched[o] = true;
+	    }
+	}
+    }
+}
+
+int NoximSwitchAllocator::maximumMatching() const
+{
+    vector <int> match_out(n_ports, NOT_VALID);
+    int size = 0;
+
+    for (int i = 0; i < n_ports; i++) {
+	vector <bool> visited(n_ports, false);
+	if (augment(i, visited, match_out))
+	    size++;
+    }
+
+    return size;
+}
+
+bool NoximSwitchAllocator::augment(const int in, vector <bool> & visited,
+				   vector <int> & match_out) const
+{
+    for (int o = 0; o < n_ports; o++) {
+	if (!eligible[in][o] || visited[o])
+	    continue;
+	visited[o] = true;
+	if (match_out[o] == NOT_VALID
+	    || augment(match_out[o], visited, match_out)) {
+	    match_out[o] = in;
+	    return true;
+	}
+    }
+
+    return false;
+}
+
+unsigned long NoximSwitchAllocator::getRequestingInputs() const
+{
+    return requesting_inputs;
+}
+
+unsigned long NoximSwitchAllocator::getGrants() const
+{
+    return granted;
+}
+
+unsigned long NoximSwitchAllocator::getMaxGrants() const
+{
+    return max_granted;
+}
+
+double NoximSwitchAllocator::getEfficiency() const
+{
+    if (max_granted == 0)
+	return 1.0;
+
+    return (double) granted / (double) max_granted;
+}
@@ -0,0 +1,114 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the switch allocator
+ */
+
+#ifndef __NOXIMSWITCHALLOCATOR_H__
+#define __NOXIMSWITCHALLOCATOR_H__
+
+#include <cassert>
+#include <vector>
+#include "NoximMain.h"
+#include "NoximReservationTable.h"
+using namespace std;
+
+class NoximSwitchAllocator {
+  public:
+
+    NoximSwitchAllocator();
+
+    // Sets the number of ports, the allocation policy and the time
+    // after which efficiency statistics are collected
+    void configure(const int _n_ports, const int _type,
+		   const int _iterations, const double _warm_up_time);
+
+    // True if the policy is able to choose among several candidate
+    // outputs of the same input (i.e. it computes a real matching)
+    bool acceptsMultipleRequests() const;
+
+    // Forgets the requests of the previous cycle
+    void clearRequests();
+
+    // Input served first in this cycle. The routing function of the
+    // inputs is evaluated from it on, so that the selection strategies
+    // draw their random numbers in the same order as the original
+    // reservation loop.
+    int firstInput() const;
+
+    // Input port_in asks for output port_out
+    void request(const int port_in, const int port_out);
+
+    // Round-robin only: reserves at once the output requested by
+    // port_in, if it is available. Called in the rotating order given
+    // by firstInput(), it lets the next inputs route knowing the
+    // reservations already made in this cycle, like the original
+    // reservation loop. Returns the output reserved or NOT_VALID.
+    int serve(NoximReservationTable & rtable, const int port_in);
+
+    // Matches the pending requests against the outputs that are
+    // available in rtable and reserves the winners (round-robin only
+    // collects the grants made by serve()). grants[i] is the output
+    // reserved by input i in this cycle or NOT_VALID.
+    // Returns the number of grants
+    int allocate(NoximReservationTable & rtable, vector <int> & grants);
+
+    // Crossbar speedup: matches again the requests of the inputs that
+    // have not won an output in this cycle against the outputs
+    // released since. The priorities do not move and the statistics
+    // only account for allocate().
+    int reallocate(NoximReservationTable & rtable, vector <int> & grants);
+
+    // Moves the rotating priorities on, once per cycle
+    void endCycle();
+
+    // Statistics
+    unsigned long getRequestingInputs() const;
+    unsigned long getGrants() const;
+    unsigned long getMaxGrants() const;
+
+    // Grants over the size of the maximum matching of the requests
+    double getEfficiency() const;
+
+  private:
+
+    int type;
+    int n_ports;
+    int iterations;		// iSLIP iterations
+    double warm_up_time;
+
+    vector < vector <bool> > requests;	// requests[i][o]
+    vector < vector <bool> > eligible;	// requests that can be satisfied
+    vector <int> served;	// outputs reserved by each input in this cycle
+    vector <bool> available;	// round-robin: outputs free when the
+				// cycle started, empty before serve()
+
+    int start_from_port;	// round-robin: first input to be served
+    vector <int> grant_pointer;	// iSLIP: per output priority pointer
+    vector <int> accept_pointer;	// iSLIP: per input priority pointer
+    int priority_diagonal;	// wavefront: first diagonal to be swept
+
+    unsigned long requesting_inputs;
+    unsigned long granted;
+    unsigned long max_granted;
+
+    void match(const vector < vector <bool> > & req,
+	       NoximReservationTable & rtable, vector <int> & grants,
+	       const bool move_pointers);
+    void allocateISLIP(const vector < vector <bool> > & req,
+		       NoximReservationTable & rtable,
+		       vector <int> & grants, const bool move_pointers);
+    void allocateWavefront(const vector < vector <bool> > & req,
+			   NoximReservationTable & rtable,
+			   vector <int> & grants);
+
+    int maximumMatching() const;
+    bool augment(const int in, vector <bool> & visited,
+		 vector <int> & match_out) const;
+};
+
+#endif
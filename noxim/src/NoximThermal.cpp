@@ -0,0 +1,133 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the thermal model
+ */
+
+#include <cmath>
+#include <cassert>
+#include "NoximThermal.h"
+
+NoximThermal::NoximThermal()
+{
+    configure(0, 0);
+}
+
+void NoximThermal::configure(const int _dimx, const int _dimy)
+{
+    dimx = _dimx;
+    dimy = _dimy;
+    rhs.assign(dimx * dimy, 0.0);
+
+    reset();
+}
+
+void NoximThermal::reset()
+{
+    temperature.assign(dimx * dimy, THERMAL_AMBIENT);
+    wear.assign(dimx * dimy, 1.0);
+    sweeps = 0;
+}
+
+double NoximThermal::sweep(const int color)
+{
+    const double g_v = 1.0 / THERMAL_R_VERTICAL;
+    const double g_l = 1.0 / THERMAL_R_LATERAL;
+    const double c = THERMAL_CAPACITANCE / THERMAL_TIME_STEP;
+
+    double change = 0.0;
+    for (int y = 0; y < dimy; y++)
+	for (int x = (y + color) % 2; x < dimx; x += 2) {
+	    int i = y * dimx + x;
+	    double diagonal = c + g_v;
+	    double sum = 0.0;
+
+	    if (x > 0) {
+		sum += temperature[i - 1];
+		diagonal += g_l;
+	    }
+	    if (x < dimx - 1) {
+		sum += temperature[i + 1];
+		diagonal += g_l;
+	    }
+	    if (y > 0) {
+		sum += temperature[i - dimx];
+		diagonal += g_l;
+	    }
+	    if (y < dimy - 1) {
+		sum += temperature[i + dimx];
+		diagonal += g_l;
+	    }
+
+	    double t = (rhs[i] + g_l * sum) / diagonal;
+	    double delta = THERMAL_SOR_OMEGA * (t - temperature[i]);
+	    temperature[i] += delta;
+	    change = max(change, fabs(delta));
+	}
+
+    return change;
+}
+
+void NoximThermal::step(const vector <double> & power)
+{
+    assert((int) power.size() == dimx * dimy);
+
+    const double g_v = 1.0 / THERMAL_R_VERTICAL;
+    const double c = THERMAL_CAPACITANCE / THERMAL_TIME_STEP;
+
+    // (C/dt + G) T = C/dt T_old + P + g_v T_ambient
+    for (int i = 0; i < dimx * dimy; i++)
+	rhs[i] = c * temperature[i] + power[i] + g_v * THERMAL_AMBIENT;
+
+    // the capacitance keeps the system strongly diagonal, so that a few
+    // sweeps from the old temperatures are enough
+    for (sweeps = 1; sweeps <= THERMAL_MAX_SWEEPS; sweeps++) {
+	double change = max(sweep(0), sweep(1));
+	if (change < THERMAL_TOLERANCE)
+	    break;
+    }
+
+    const double k = ACTIVATION_ENERGY / BOLTZMANN_CONSTANT;
+    for (int i = 0; i < dimx * dimy; i++)
+	wear[i] = exp(k * (1.0 / THERMAL_AMBIENT - 1.0 / temperature[i]));
+}
+
+double NoximThermal::getTemperature(const int tile) const
+{
+    return temperature[tile];
+}
+
+double NoximThermal::getPeakTemperature() const
+{
+    double peak = THERMAL_AMBIENT;
+    for (unsigned int i = 0; i < temperature.size(); i++)
+	peak = max(peak, temperature[i]);
+
+    return peak;
+}
+
+double NoximThermal::getAverageTemperature() const
+{
+    if (temperature.empty())
+	return THERMAL_AMBIENT;
+
+    double sum = 0.0;
+    for (unsigned int i = 0; i < temperature.size(); i++)
+	sum += temperature[i];
+
+    return sum / temperature.size();
+}
+
+double NoximThermal::getWearFactor(const int tile) const
+{
+    return wear[tile];
+}
+
+int NoximThermal::getSweeps() const
+{
+    return sweeps;
+}
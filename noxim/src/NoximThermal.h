@@ -0,0 +1,63 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the thermal model
+ */
+
+#ifndef __NOXIMTHERMAL_H__
+#define __NOXIMTHERMAL_H__
+
+#include <vector>
+#include "NoximMain.h"
+using namespace std;
+
+// Compact thermal model of the mesh: every tile, router and PEs, is a
+// node of an RC grid, tied to the ambient by a vertical resistance and
+// to the tiles next to it by a lateral one. A step is an implicit
+// (backward Euler) one, so that it is stable whatever its length, and
+// the five-point system is solved by red-black SOR, starting from the
+// temperatures of the step before.
+class NoximThermal {
+  public:
+
+    NoximThermal();
+
+    // Sets the size of the grid and resets it
+    void configure(const int _dimx, const int _dimy);
+
+    // Every tile is at the ambient temperature
+    void reset();
+
+    // Advances by THERMAL_TIME_STEP seconds, power being the average
+    // power of each tile in W, indexed by router id
+    void step(const vector <double> & power);
+
+    double getTemperature(const int tile) const;	// K
+    double getPeakTemperature() const;
+    double getAverageTemperature() const;
+
+    // Wear rate of tile, relative to the one at the ambient
+    // temperature (Arrhenius)
+    double getWearFactor(const int tile) const;
+
+    int getSweeps() const;	// Of the last step
+
+  private:
+
+    int dimx;
+    int dimy;
+    vector <double> temperature;
+    vector <double> wear;
+    vector <double> rhs;	// Of the system of the current step
+    int sweeps;
+
+    // Updates the tiles of one color of the checkerboard, returns the
+    // largest change
+    double sweep(const int color);
+};
+
+#endif
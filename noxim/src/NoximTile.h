@@ -23,36 +23,50 @@ SC_MODULE(NoximTile)
     sc_in_clk clock;		                // The input clock for the tile
     sc_in <bool> reset;	                        // The reset signal for the tile
 
-    sc_in <NoximFlit> flit_rx[DIRECTIONS];	// The input channels
-    sc_in <bool> req_rx[DIRECTIONS];	        // The requests associated with the input channels
-    sc_out <bool> ack_rx[DIRECTIONS];	        // The outgoing ack signals associated with the input channels
+    // Network ports: the mesh directions followed by the express ones
+    sc_in <NoximFlitBundle> flit_rx[DIRECTIONS + EXPRESS_DIRECTIONS];	// The input channels
+    sc_in <bool> req_rx[DIRECTIONS + EXPRESS_DIRECTIONS];	        // The requests associated with the input channels
+    sc_out <bool> ack_rx[DIRECTIONS + EXPRESS_DIRECTIONS];	        // The outgoing ack signals associated with the input channels
 
-    sc_out <NoximFlit> flit_tx[DIRECTIONS];	// The output channels
-    sc_out <bool> req_tx[DIRECTIONS];	        // The requests associated with the output channels
-    sc_in <bool> ack_tx[DIRECTIONS];	        // The outgoing ack signals associated with the output channels
+    sc_out <NoximFlitBundle> flit_tx[DIRECTIONS + EXPRESS_DIRECTIONS];	// The output channels
+    sc_out <bool> req_tx[DIRECTIONS + EXPRESS_DIRECTIONS];	        // The requests associated with the output channels
+    sc_in <bool> ack_tx[DIRECTIONS + EXPRESS_DIRECTIONS];	        // The outgoing ack signals associated with the output channels
 
-    sc_out <int> free_slots[DIRECTIONS];
-    sc_in <int> free_slots_neighbor[DIRECTIONS];
+    sc_out <int> free_slots[DIRECTIONS + EXPRESS_DIRECTIONS];
+    sc_in <int> free_slots_neighbor[DIRECTIONS + EXPRESS_DIRECTIONS];
+
+    // Virtual channel credits
+    sc_out <NoximCreditCount> credits[DIRECTIONS];
+    sc_in <NoximCreditCount> credits_neighbor[DIRECTIONS];
 
     // NoP related I/O
     sc_out < NoximNoP_data > NoP_data_out[DIRECTIONS];
     sc_in < NoximNoP_data > NoP_data_in[DIRECTIONS];
 
-    // Signals
-    sc_signal <NoximFlit> flit_rx_local;	// The input channels
-    sc_signal <bool> req_rx_local;              // The requests associated with the input channels
-    sc_signal <bool> ack_rx_local;	        // The outgoing ack signals associated with the input channels
+    // Regional congestion I/O
+    sc_out <double> congestion_out[DIRECTIONS];
+    sc_in <double> congestion_in[DIRECTIONS];
+
+    // SMART bypass I/O
+    sc_out <NoximSmartLink> smart_out[DIRECTIONS];
+    sc_in <NoximSmartLink> smart_in[DIRECTIONS];
+
+    // Signals (one set for each local port, the spare ones tie off the
+    // router ports that are not used)
+    sc_signal <NoximFlitBundle> flit_rx_local[MAX_ROUTER_PORTS - DIRECTIONS];	// The input channels
+    sc_signal <bool> req_rx_local[MAX_ROUTER_PORTS - DIRECTIONS];              // The requests associated with the input channels
+    sc_signal <bool> ack_rx_local[MAX_ROUTER_PORTS - DIRECTIONS];	        // The outgoing ack signals associated with the input channels
 
-    sc_signal <NoximFlit> flit_tx_local;	// The output channels
-    sc_signal <bool> req_tx_local;	        // The requests associated with the output channels
-    sc_signal <bool> ack_tx_local;	        // The outgoing ack signals associated with the output channels
+    sc_signal <NoximFlitBundle> flit_tx_local[MAX_ROUTER_PORTS - DIRECTIONS];	// The output channels
+    sc_signal <bool> req_tx_local[MAX_ROUTER_PORTS - DIRECTIONS];	        // The requests associated with the output channels
+    sc_signal <bool> ack_tx_local[MAX_ROUTER_PORTS - DIRECTIONS];	        // The outgoing ack signals associated with the output channels
 
-    sc_signal <int> free_slots_local;
-    sc_signal <int> free_slots_neighbor_local;
+    sc_signal <int> free_slots_local[MAX_ROUTER_PORTS - DIRECTIONS];
+    sc_signal <int> free_slots_neighbor_local[MAX_ROUTER_PORTS - DIRECTIONS];
 
     // Instances
     NoximRouter *r;		                // Router instance
-    NoximProcessingElement *pe;	                // Processing Element instance
+    NoximProcessingElement *pe[MAX_CONCENTRATION];	// Processing Element instances (NULL if unused)
 
     // Constructor
 
@@ -74,37 +88,82 @@ SC_MODULE(NoximTile)
 	    r->free_slots[i] (free_slots[i]);
 	    r->free_slots_neighbor[i] (free_slots_neighbor[i]);
 
+	    r->credits[i] (credits[i]);
+	    r->credits_neighbor[i] (credits_neighbor[i]);
+
 	    // NoP 
 	    r->NoP_data_out[i] (NoP_data_out[i]);
 	    r->NoP_data_in[i] (NoP_data_in[i]);
-	}
 
-	r->flit_rx[DIRECTION_LOCAL] (flit_tx_local);
-	r->req_rx[DIRECTION_LOCAL] (req_tx_local);
-	r->ack_rx[DIRECTION_LOCAL] (ack_tx_local);
+	    // Regional congestion
+	    r->congestion_out[i] (congestion_out[i]);
+	    r->congestion_in[i] (congestion_in[i]);
 
-	r->flit_tx[DIRECTION_LOCAL] (flit_rx_local);
-	r->req_tx[DIRECTION_LOCAL] (req_rx_local);
-	r->ack_tx[DIRECTION_LOCAL] (ack_rx_local);
+	    // SMART bypass
+	    r->smart_out[i] (smart_out[i]);
+	    r->smart_in[i] (smart_in[i]);
+	}
 
-	r->free_slots[DIRECTION_LOCAL] (free_slots_local);
-	r->free_slots_neighbor[DIRECTION_LOCAL]
-	    (free_slots_neighbor_local);
+	// The express ports follow the local ones: they carry the express
+	// links or the links a graph numbers past the mesh ports. Local
+	// ports beyond the concentration are bound but never used.
+	int express = DIRECTIONS + NoximGlobalParams::concentration;
+	for (int k = 0; k < MAX_ROUTER_PORTS - DIRECTIONS; k++) {
+	    int l = DIRECTION_LOCAL + k;
+
+	    if ((NoximGlobalParams::express_span > 0 ||
+		 NoximGlobalParams::topology == TOPOLOGY_GRAPH) &&
+		l >= express && l < express + EXPRESS_DIRECTIONS) {
+		int e = DIRECTIONS + l - express;
+
+		r->flit_rx[l] (flit_rx[e]);
+		r->req_rx[l] (req_rx[e]);
+		r->ack_rx[l] (ack_rx[e]);
+
+		r->flit_tx[l] (flit_tx[e]);
+		r->req_tx[l] (req_tx[e]);
+		r->ack_tx[l] (ack_tx[e]);
+
+		r->free_slots[l] (free_slots[e]);
+		r->free_slots_neighbor[l] (free_slots_neighbor[e]);
+		continue;
+	    }
+
+	    r->flit_rx[l] (flit_tx_local[k]);
+	    r->req_rx[l] (req_tx_local[k]);
+	    r->ack_rx[l] (ack_tx_local[k]);
+
+	    r->flit_tx[l] (flit_rx_local[k]);
+	    r->req_tx[l] (req_rx_local[k]);
+	    r->ack_tx[l] (ack_rx_local[k]);
+
+	    r->free_slots[l] (free_slots_local[k]);
+	    r->free_slots_neighbor[l] (free_slots_neighbor_local[k]);
+	}
 
 	// Processing Element pin assignments
-	pe = new NoximProcessingElement("ProcessingElement");
-	pe->clock(clock);
-	pe->reset(reset);
-
-	pe->flit_rx(flit_rx_local);
-	pe->req_rx(req_rx_local);
-	pe->ack_rx(ack_rx_local);
-
-	pe->flit_tx(flit_tx_local);
-	pe->req_tx(req_tx_local);
-	pe->ack_tx(ack_tx_local);
-
-	pe->free_slots_neighbor(free_slots_neighbor_local);
+	for (int k = 0; k < MAX_CONCENTRATION; k++) {
+	    if (k >= NoximGlobalParams::concentration) {
+		pe[k] = NULL;
+		continue;
+	    }
+
+	    char pe_name[32];
+	    sprintf(pe_name, "ProcessingElement[%d]", k);
+	    pe[k] = new NoximProcessingElement(pe_name);
+	    pe[k]->clock(clock);
+	    pe[k]->reset(reset);
+
+	    pe[k]->flit_rx(flit_rx_local[k]);
+	    pe[k]->req_rx(req_rx_local[k]);
+	    pe[k]->ack_rx(ack_rx_local[k]);
+
+	    pe[k]->flit_tx(flit_tx_local[k]);
+	    pe[k]->req_tx(req_tx_local[k]);
+	    pe[k]->ack_tx(ack_tx_local[k]);
+
+	    pe[k]->free_slots_neighbor(free_slots_neighbor_local[k]);
+	}
 
     }
 